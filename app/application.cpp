@@ -1,9 +1,7 @@
-#include "application.hpp"
+#include "applicationRunner.hpp"
 
 int main(int argc, char **argv) {
 
-  Application<VIENNAPS_APP_DIM> app(argc, argv);
-  app.run();
-
-  return 0;
-}
\ No newline at end of file
+  ApplicationRunner<VIENNAPS_APP_DIM> runner(argc, argv);
+  return runner.run();
+}
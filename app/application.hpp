@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 
 #include <lsReader.hpp>
 
@@ -25,6 +26,8 @@
 #include <psProcess.hpp>
 #include <psUtils.hpp>
 
+#include "applicationBenchmark.hpp"
+#include "applicationCache.hpp"
 #include "applicationParameters.hpp"
 #include "applicationParser.hpp"
 
@@ -34,37 +37,128 @@ template <int D> class Application {
   SmartPointer<Domain<NumericType, D>> geometry = nullptr;
   SmartPointer<ApplicationParameters> params = nullptr;
   ApplicationParser parser;
-  int clArgC = 0;
-  char **clArgV;
+  std::string inputFileName;
+  SmartPointer<GeometryCache<D>> cache = nullptr;
+  std::string benchmarkFileName;
+  SmartPointer<BenchmarkReport<D>> benchmark = nullptr;
+  // Statistics of the process run by the last PROCESS command
+  ProcessStatistics processStatistics;
+  // Number of commands that could not be executed
+  unsigned numErrors = 0;
 
 public:
-  Application(int argc, char **argv) : clArgC(argc), clArgV(argv) {}
+  Application(int argc, char **argv) {
+    if (argc > 1)
+      inputFileName = argv[1];
+  }
+
+  Application(std::string passedInputFileName)
+      : inputFileName(passedInputFileName) {}
 
-  void run() {
-    if (clArgC < 2) {
+  // Returns 0 if all commands were executed and 1 otherwise.
+  int run() {
+    numErrors = 0;
+    if (inputFileName.empty()) {
       Logger::getInstance().addError("No input file specified.").print();
-      return;
+      return 1;
     }
 
     std::fstream inputFile;
-    inputFile.open(clArgV[1], std::fstream::in);
+    inputFile.open(inputFileName, std::fstream::in);
 
     if (!inputFile.is_open()) {
       Logger::getInstance().addError("Could not open input file.").print();
-      return;
+      return 1;
     }
 
+    if (!benchmarkFileName.empty())
+      benchmark = SmartPointer<BenchmarkReport<D>>::New(benchmarkFileName,
+                                                        inputFileName);
+
     params = SmartPointer<ApplicationParameters>::New();
     params->defaultParameters(true);
     parser.setParameters(params);
 
-    int lineNumber = 0;
+    std::vector<std::string> lines;
     std::string line;
     while (std::getline(inputFile, line)) {
       if (line.empty() || line[0] == '#') // skipping empty line and comments
         continue;
-      std::istringstream lineStream(line);
-      switch (parser.parseCommand(lineStream, lineNumber)) {
+      lines.push_back(line);
+    }
+
+    // Key of the geometry state after each line. With a cache, the commands
+    // up to the last line whose state is stored are only parsed, and the
+    // geometry is restored from the cache.
+    std::vector<uint64_t> keys(lines.size());
+    std::size_t resumeLine = 0;
+    if (cache) {
+      uint64_t key = GeometryCache<D>::rootKey();
+      for (std::size_t i = 0; i < lines.size(); i++) {
+        auto command = GeometryCache<D>::normalize(lines[i]);
+        if (!command.empty()) {
+          key = GeometryCache<D>::nextKey(key, command);
+          if (cache->contains(key))
+            resumeLine = i + 1;
+        }
+        keys[i] = key;
+      }
+    }
+
+    // Load the geometry written by the OUTPUT lines in the skipped prefix and
+    // the geometry to resume from. If a state can not be loaded, this is a
+    // cache miss and the job resumes from the last cached state before it.
+    std::unordered_map<std::size_t, SmartPointer<Domain<NumericType, D>>>
+        restored;
+    for (std::size_t i = 0; i < resumeLine;) {
+      if (i + 1 != resumeLine && !isOutput(lines[i])) {
+        ++i;
+        continue;
+      }
+      if (!restored.count(i)) {
+        auto state = cache->load(keys[i]);
+        if (!state) {
+          std::cout << "\tGeometry after line " << i + 1
+                    << " not found in cache\n";
+          resumeLine = 0;
+          for (std::size_t j = 0; j < i; j++)
+            if (!GeometryCache<D>::normalize(lines[j]).empty() &&
+                cache->contains(keys[j]))
+              resumeLine = j + 1;
+          i = resumeLine > 0 ? resumeLine - 1 : 0;
+          continue;
+        }
+        restored[i] = state;
+      }
+      ++i;
+    }
+
+    for (std::size_t lineNumber = 0; lineNumber < lines.size(); lineNumber++) {
+      std::istringstream lineStream(lines[lineNumber]);
+      auto command = parser.parseCommand(lineStream, lineNumber);
+      if (command == CommandType::NONE)
+        ++numErrors;
+
+      if (lineNumber < resumeLine) {
+        if (command == CommandType::OUTPUT || lineNumber + 1 == resumeLine)
+          geometry = restored.at(lineNumber);
+        if (command == CommandType::OUTPUT)
+          writeOutput();
+        if (lineNumber + 1 == resumeLine)
+          std::cout << "\tRestored geometry from cache ("
+                    << GeometryCache<D>::toString(keys[lineNumber])
+                    << ")\n\n";
+        if (benchmark)
+          benchmark->addCommand(lineNumber, lines[lineNumber], true, 0.,
+                                geometry);
+        params->defaultParameters();
+        continue;
+      }
+
+      Timer commandTimer;
+      commandTimer.start();
+      processStatistics = ProcessStatistics();
+      switch (command) {
       case CommandType::INIT:
         runInit();
         break;
@@ -91,18 +185,57 @@ public:
       default:
         assert(false);
       }
+      commandTimer.finish();
+
+      if (benchmark)
+        benchmark->addCommand(
+            lineNumber, lines[lineNumber], false,
+            commandTimer.currentDuration * 1e-9, geometry,
+            command == CommandType::PROCESS ? &processStatistics : nullptr);
+
+      if (cache && command != CommandType::OUTPUT &&
+          command != CommandType::NONE && geometry &&
+          !geometry->getLevelSets().empty())
+        cache->store(keys[lineNumber], geometry);
 
-      lineNumber++;
       params->defaultParameters();
     }
+
+    if (benchmark)
+      benchmark->write();
+
+    return numErrors == 0 ? 0 : 1;
+  }
+
+  // Store the geometry after each command in a content-addressed cache in the
+  // given directory, and resume from the longest cached command prefix.
+  void setCacheDirectory(std::string directory) {
+    cache = SmartPointer<GeometryCache<D>>::New(directory);
   }
 
+  // Record the time of each command and of each phase of every process time
+  // step, and write them to the given file in JSON or CSV format.
+  void setBenchmarkFile(std::string fileName) { benchmarkFileName = fileName; }
+
   void printGeometry(std::string fileName) {
     params->fileName = fileName;
     writeOutput();
   }
 
 protected:
+  static bool isOutput(const std::string &line) {
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+    return command == "OUTPUT";
+  }
+
+  // Runs the process and keeps its statistics for the benchmark report.
+  void applyProcess(Process<NumericType, D> &process) {
+    process.apply();
+    processStatistics = process.getStatistics();
+  }
+
   virtual void
   runSingleParticleProcess(SmartPointer<Domain<NumericType, D>> processGeometry,
                            SmartPointer<ApplicationParameters> processParams) {
@@ -122,7 +255,7 @@ protected:
     process.setNumberOfRaysPerPoint(processParams->raysPerPoint);
     process.setProcessDuration(processParams->processTime);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -144,7 +277,7 @@ protected:
     process.setNumberOfRaysPerPoint(processParams->raysPerPoint);
     process.setProcessDuration(processParams->processTime);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -165,7 +298,7 @@ protected:
     process.setNumberOfRaysPerPoint(processParams->raysPerPoint);
     process.setProcessDuration(processParams->processTime);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -186,7 +319,7 @@ protected:
     process.setNumberOfRaysPerPoint(processParams->raysPerPoint);
     process.setProcessDuration(processParams->processTime);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -199,7 +332,7 @@ protected:
     process.setDomain(processGeometry);
     process.setProcessModel(model);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -212,7 +345,7 @@ protected:
     process.setDomain(processGeometry);
     process.setProcessModel(model);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -228,7 +361,7 @@ protected:
     process.setProcessModel(model);
     process.setProcessDuration(params->processTime);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -248,7 +381,7 @@ protected:
     process.setProcessModel(model);
     process.setProcessDuration(params->processTime);
     process.setIntegrationScheme(params->integrationScheme);
-    process.apply();
+    applyProcess(process);
   }
 
   virtual void
@@ -373,6 +506,7 @@ private:
         Logger::getInstance()
             .addError("Can only parse GDS geometries in 3D application.")
             .print();
+        ++numErrors;
       }
       break;
     }
@@ -394,6 +528,7 @@ private:
                     << params->gridDelta << ", Import grid resolution: "
                     << layer->getGrid().getGridDelta()
                     << "\nCannot add geometry." << std::endl;
+          ++numErrors;
           continue;
         }
         geometry->insertNextLevelSet(layer, false);
@@ -411,6 +546,7 @@ private:
       Logger::getInstance()
           .addError("Cannot run process on empty geometry.")
           .print();
+      ++numErrors;
       return;
     }
 
@@ -524,6 +660,7 @@ private:
       Logger::getInstance()
           .addWarning("Process model could not be parsed. Skipping line.")
           .print();
+      ++numErrors;
       break;
 
     default:
@@ -539,6 +676,7 @@ private:
   void writeOutput() {
     if (geometry->getLevelSets().empty()) {
       std::cout << "Cannot write empty geometry." << std::endl;
+      ++numErrors;
       return;
     }
 
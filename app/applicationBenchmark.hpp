@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <psProcess.hpp>
+
+#include "applicationParameters.hpp"
+
+using namespace viennaps;
+
+// Machine-readable timing report of an application run. For every command,
+// the wall time and the size of the geometry are recorded; for processes,
+// additionally the timings of each phase per time step. The report is written
+// as JSON, or as CSV with one row per time step if the file name ends with
+// ".csv".
+template <int D> class BenchmarkReport {
+  struct CommandRecord {
+    std::size_t line = 0;
+    std::string command;
+    // Restored from the geometry cache instead of being executed
+    bool cached = false;
+    double time = 0.;
+    std::size_t numLevelSets = 0;
+    std::size_t numLevelSetPoints = 0;
+    bool isProcess = false;
+    ProcessStatistics process;
+  };
+
+  std::string fileName;
+  std::string configFile;
+  std::vector<CommandRecord> commands;
+
+  static std::string escape(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+        escaped += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        escaped += buffer;
+      } else {
+        escaped += c;
+      }
+    }
+    return escaped;
+  }
+
+  static std::string csvEscape(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+      if (c == '"')
+        escaped += '"';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  template <class T>
+  static void writeList(std::ostream &out, const std::vector<T> &values,
+                        char separator) {
+    for (std::size_t i = 0; i < values.size(); ++i)
+      out << (i > 0 ? std::string(1, separator) : "") << values[i];
+  }
+
+  static int numThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  void writeJSON(std::ostream &out) const {
+    double totalTime = 0.;
+    for (const auto &record : commands)
+      totalTime += record.time;
+
+    out << "{\n"
+        << "  \"config\": \"" << escape(configFile) << "\",\n"
+        << "  \"dimension\": " << D << ",\n"
+        << "  \"numericType\": \""
+        << (sizeof(NumericType) == sizeof(double) ? "double" : "float")
+        << "\",\n"
+        << "  \"threads\": " << numThreads() << ",\n"
+        << "  \"hardwareThreads\": " << std::thread::hardware_concurrency()
+        << ",\n"
+        << "  \"totalTime\": " << totalTime << ",\n"
+        << "  \"commands\": [";
+    for (std::size_t c = 0; c < commands.size(); ++c) {
+      const auto &record = commands[c];
+      out << (c > 0 ? "," : "") << "\n    {\n"
+          << "      \"line\": " << record.line << ",\n"
+          << "      \"command\": \"" << escape(record.command) << "\",\n"
+          << "      \"cached\": " << (record.cached ? "true" : "false") << ",\n"
+          << "      \"time\": " << record.time << ",\n"
+          << "      \"levelSets\": " << record.numLevelSets << ",\n"
+          << "      \"levelSetPoints\": " << record.numLevelSetPoints;
+      if (record.isProcess) {
+        const auto &process = record.process;
+        out << ",\n      \"process\": {\n"
+            << "        \"totalTime\": " << process.totalTime << ",\n"
+            << "        \"coverageInitTime\": " << process.coverageInitTime
+            << ",\n"
+            << "        \"steps\": [";
+        for (std::size_t i = 0; i < process.steps.size(); ++i) {
+          const auto &step = process.steps[i];
+          out << (i > 0 ? "," : "") << "\n          {"
+              << "\"processTime\": " << step.processTime
+              << ", \"timeStep\": " << step.timeStep
+              << ", \"surfacePoints\": " << step.numSurfacePoints
+              << ", \"levelSetPoints\": " << step.numLevelSetPoints
+              << ", \"raysTraced\": [";
+          writeList(out, step.raysTraced, ',');
+          out << "], \"diskMeshTime\": " << step.diskMeshTime
+              << ", \"tracingTimes\": [";
+          writeList(out, step.tracingTimes, ',');
+          out << "], \"fluxTime\": " << step.fluxTime
+              << ", \"surfaceModelTime\": " << step.surfaceModelTime
+              << ", \"advectionTime\": " << step.advectionTime
+              << ", \"callbackTime\": " << step.callbackTime << "}";
+        }
+        out << (process.steps.empty() ? "" : "\n        ") << "]\n      }";
+      }
+      out << "\n    }";
+    }
+    out << (commands.empty() ? "" : "\n  ") << "]\n}\n";
+  }
+
+  // One row per time step of a process and one row per other command. Values
+  // per particle type are separated by semicolons.
+  void writeCSV(std::ostream &out) const {
+    out << "line,command,cached,commandTime,levelSets,levelSetPoints,step,"
+           "processTime,timeStep,surfacePoints,raysTraced,diskMeshTime,"
+           "tracingTimes,fluxTime,surfaceModelTime,advectionTime,"
+           "callbackTime\n";
+    for (const auto &record : commands) {
+      std::ostringstream prefix;
+      prefix << record.line << ",\"" << csvEscape(record.command) << "\","
+             << record.cached << ',' << record.time << ','
+             << record.numLevelSets << ',' << record.numLevelSetPoints << ',';
+      if (!record.isProcess || record.process.steps.empty()) {
+        out << prefix.str() << ",,,,,,,,,,\n";
+        continue;
+      }
+      for (std::size_t i = 0; i < record.process.steps.size(); ++i) {
+        const auto &step = record.process.steps[i];
+        out << prefix.str() << i << ',' << step.processTime << ','
+            << step.timeStep << ',' << step.numSurfacePoints << ',';
+        writeList(out, step.raysTraced, ';');
+        out << ',' << step.diskMeshTime << ',';
+        writeList(out, step.tracingTimes, ';');
+        out << ',' << step.fluxTime << ',' << step.surfaceModelTime << ','
+            << step.advectionTime << ',' << step.callbackTime << '\n';
+      }
+    }
+  }
+
+public:
+  BenchmarkReport(std::string passedFileName, std::string passedConfigFile)
+      : fileName(passedFileName), configFile(passedConfigFile) {}
+
+  // Records a command. The statistics are only used for process commands.
+  void addCommand(std::size_t line, const std::string &command, bool cached,
+                  double time, SmartPointer<Domain<NumericType, D>> geometry,
+                  const ProcessStatistics *process = nullptr) {
+    CommandRecord record;
+    record.line = line;
+    record.command = command;
+    record.cached = cached;
+    record.time = time;
+    if (geometry && !geometry->getLevelSets().empty()) {
+      record.numLevelSets = geometry->getLevelSets().size();
+      record.numLevelSetPoints =
+          geometry->getLevelSets().back()->getNumberOfPoints();
+    }
+    if (process) {
+      record.isProcess = true;
+      record.process = *process;
+    }
+    commands.push_back(std::move(record));
+  }
+
+  bool write() const {
+    std::ofstream file(fileName);
+    if (!file.is_open()) {
+      Logger::getInstance()
+          .addWarning("Could not write benchmark report '" + fileName + "'.")
+          .print();
+      return false;
+    }
+    file << std::setprecision(9);
+    const std::string suffix = ".csv";
+    if (fileName.size() >= suffix.size() &&
+        fileName.compare(fileName.size() - suffix.size(), suffix.size(),
+                         suffix) == 0)
+      writeCSV(file);
+    else
+      writeJSON(file);
+    return true;
+  }
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lsReader.hpp>
+#include <lsWriter.hpp>
+
+#include <psDomain.hpp>
+#include <psMappedFile.hpp>
+
+#include "applicationParameters.hpp"
+
+using namespace viennaps;
+
+// Content-addressed cache of geometry states. A state is identified by a hash
+// of the normalized commands that produced it. Config files sharing a command
+// prefix can then resume from the stored geometry instead of recomputing it.
+// Each state is stored in its own directory, containing the level sets and
+// the material of each level set.
+template <int D> class GeometryCache {
+  using DomainType = SmartPointer<Domain<NumericType, D>>;
+
+  // Has to be increased if the meaning of the commands or the storage format
+  // changes, so that old states are no longer used.
+  static constexpr uint32_t version = 1;
+
+  std::string directory;
+
+  // 64-bit FNV-1a hash
+  static void hashBytes(uint64_t &hash, const void *data, std::size_t size) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+  }
+
+  std::filesystem::path statePath(uint64_t key) const {
+    return std::filesystem::path(directory) / toString(key);
+  }
+
+public:
+  GeometryCache(std::string passedDirectory) : directory(passedDirectory) {}
+
+  // Key of the initial, empty state.
+  static uint64_t rootKey() {
+    uint64_t key = 14695981039346656037ull;
+    const uint32_t dimension = D;
+    const uint32_t valueSize = sizeof(NumericType);
+    hashBytes(key, &version, sizeof(version));
+    hashBytes(key, &dimension, sizeof(dimension));
+    hashBytes(key, &valueSize, sizeof(valueSize));
+    return key;
+  }
+
+  // Key of the state after applying a normalized command to the state with
+  // the given key. The content of files read by the command (file=...) is
+  // part of the key.
+  static uint64_t nextKey(uint64_t key, const std::string &command) {
+    hashBytes(key, command.data(), command.size() + 1);
+    std::istringstream stream(command);
+    std::string token;
+    while (stream >> token) {
+      if (token.rfind("file=", 0) != 0)
+        continue;
+      utils::MappedFile file;
+      if (file.open(token.substr(5)))
+        hashBytes(key, file.data(), file.size());
+    }
+    return key;
+  }
+
+  // Normalizes a config line by removing comments and superfluous whitespace
+  // and sorting the parameters. Returns an empty string for lines that do not
+  // change the geometry.
+  static std::string normalize(const std::string &line) {
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+    if (command != "INIT" && command != "GEOMETRY" && command != "PROCESS" &&
+        command != "PLANARIZE")
+      return "";
+
+    std::string normalized = command;
+    std::vector<std::string> parameters;
+    std::string token;
+    while (stream >> token) {
+      if (token[0] == '#')
+        continue;
+      if (token.find('=') == std::string::npos) {
+        normalized += ' ' + token;
+      } else if (token.rfind("logLevel=", 0) != 0) {
+        // The log level does not affect the geometry
+        parameters.push_back(token);
+      }
+    }
+    // The parser uses the first occurrence of a parameter
+    std::vector<std::string> unique;
+    std::set<std::string> names;
+    for (const auto &parameter : parameters)
+      if (names.insert(parameter.substr(0, parameter.find('='))).second)
+        unique.push_back(parameter);
+    std::sort(unique.begin(), unique.end());
+    for (const auto &parameter : unique)
+      normalized += ' ' + parameter;
+    return normalized;
+  }
+
+  static std::string toString(uint64_t key) {
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << key;
+    return stream.str();
+  }
+
+  bool contains(uint64_t key) const {
+    std::error_code ec;
+    return std::filesystem::exists(statePath(key) / "state.txt", ec);
+  }
+
+  // Stores the geometry under the given key. The state is written to a
+  // temporary directory first and then renamed, so that concurrent jobs never
+  // see partially written states.
+  bool store(uint64_t key, DomainType domain) const {
+    namespace fs = std::filesystem;
+    if (contains(key))
+      return true;
+
+    const auto target = statePath(key);
+    const fs::path tmp =
+        target.string() + ".tmp" + std::to_string(std::random_device{}());
+    std::error_code ec;
+    fs::create_directories(tmp, ec);
+    if (ec) {
+      Logger::getInstance()
+          .addWarning("Could not create cache directory '" + tmp.string() +
+                      "'.")
+          .print();
+      return false;
+    }
+
+    const auto &levelSets = domain->getLevelSets();
+    const auto &materialMap = domain->getMaterialMap();
+    std::ofstream state(tmp / "state.txt");
+    state << levelSets.size() << ' ' << (materialMap ? 1 : 0) << '\n';
+    for (std::size_t i = 0; i < levelSets.size(); ++i) {
+      viennals::Writer<NumericType, D>(
+          levelSets[i],
+          (tmp / ("layer" + std::to_string(i) + ".lvst")).string())
+          .apply();
+      state << (materialMap ? static_cast<int>(materialMap->getMaterialAtIdx(i))
+                            : 0)
+            << '\n';
+    }
+    state.close();
+
+    fs::rename(tmp, target, ec);
+    if (ec) {
+      // The state has been stored by another job in the meantime
+      fs::remove_all(tmp, ec);
+    }
+    return true;
+  }
+
+  // Loads the geometry stored under the given key. Returns nullptr if there
+  // is no such state.
+  DomainType load(uint64_t key) const {
+    const auto path = statePath(key);
+    std::ifstream state(path / "state.txt");
+    std::size_t numLevelSets = 0;
+    int hasMaterialMap = 0;
+    if (!(state >> numLevelSets >> hasMaterialMap))
+      return nullptr;
+
+    auto domain = DomainType::New();
+    for (std::size_t i = 0; i < numLevelSets; ++i) {
+      int material = 0;
+      if (!(state >> material))
+        return nullptr;
+      auto levelSet = SmartPointer<viennals::Domain<NumericType, D>>::New();
+      viennals::Reader<NumericType, D>(
+          levelSet, (path / ("layer" + std::to_string(i) + ".lvst")).string())
+          .apply();
+      if (hasMaterialMap)
+        domain->insertNextLevelSetAsMaterial(
+            levelSet, MaterialMap::mapToMaterial(material), false);
+      else
+        domain->insertNextLevelSet(levelSet, false);
+    }
+    return domain;
+  }
+};
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "application.hpp"
+
+// Runs one or many config files. A single config file without options is run
+// directly, as before. Otherwise, every config file (and every combination of
+// sweep values) is run as a separate job. Jobs are executed in a bounded pool
+// of worker processes, each limited to a fixed number of OpenMP threads, so
+// that the machine is not oversubscribed. The output of each job is written to
+// its own log file and a summary table is printed at the end.
+template <int D> class ApplicationRunner {
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    std::string name;
+    std::string configFile;
+    // Sweep values of this job
+    std::string parameters;
+    std::string logFile;
+    // Exit code of the job, 128 + signal number if it was killed
+    int status = -1;
+    double time = 0.;
+  };
+
+  std::vector<std::string> configFiles;
+  std::vector<std::pair<std::string, std::vector<std::string>>> sweep;
+  std::string logDir = "logs";
+  // Directory of the geometry cache, empty if no cache is used
+  std::string cacheDir;
+  // Format of the benchmark reports (json or csv), empty if disabled
+  std::string benchmarkFormat;
+  // Number of concurrent jobs and OpenMP threads per job, 0 means automatic
+  int numJobs = 0;
+  int numThreads = 0;
+  bool batchMode = false;
+  std::vector<Job> jobs;
+
+  static void printUsage() {
+    std::cout
+        << "Usage: ViennaPS" << D << "D [options] <config> [<config> ...]\n\n"
+        << "Options:\n"
+        << "  -j, --jobs <n>        number of jobs run concurrently\n"
+        << "  -t, --threads <n>     number of OpenMP threads per job\n"
+        << "  -s, --sweep <n=a,b>   run each config for every value of the\n"
+        << "                        placeholder ${n}, can be repeated\n"
+        << "  -l, --log-dir <dir>   directory for job logs and the summary\n"
+        << "                        (default: logs)\n"
+        << "  -c, --cache <dir>     cache the geometry after each command in\n"
+        << "                        <dir> and reuse it in later jobs\n"
+        << "  -b, --benchmark <fmt> write a timing report per job to the log\n"
+        << "                        directory, <fmt> is json or csv\n"
+        << "  -h, --help            print this message\n";
+  }
+
+  static int parseCount(const std::string &option, const std::string &value) {
+    auto count = utils::safeConvert<int>(value);
+    if (!count || *count < 1)
+      Logger::getInstance()
+          .addError("Invalid value '" + value + "' for option " + option)
+          .print();
+    return count.value_or(1);
+  }
+
+  void parseSweep(const std::string &spec) {
+    auto pos = spec.find('=');
+    if (pos == std::string::npos || pos == 0 || pos + 1 == spec.size()) {
+      Logger::getInstance()
+          .addError("Invalid sweep '" + spec + "', expected name=a,b,...")
+          .print();
+      return;
+    }
+    std::vector<std::string> values;
+    std::istringstream stream(spec.substr(pos + 1));
+    std::string value;
+    while (std::getline(stream, value, ','))
+      if (!value.empty())
+        values.push_back(value);
+    sweep.push_back({spec.substr(0, pos), values});
+  }
+
+  static std::string replaceAll(std::string text, const std::string &from,
+                                const std::string &to) {
+    std::size_t pos = 0;
+    while ((pos = text.find(from, pos)) != std::string::npos) {
+      text.replace(pos, from.size(), to);
+      pos += to.size();
+    }
+    return text;
+  }
+
+  static std::string jobName(std::size_t index, const std::string &config) {
+    std::ostringstream name;
+    name << std::setw(4) << std::setfill('0') << index << '_'
+         << std::filesystem::path(config).stem().string();
+    return name.str();
+  }
+
+  // Creates one job per config file, or one job per config file and
+  // combination of sweep values. For sweeps, the placeholders ${name} and
+  // ${job} are replaced in a copy of the config file stored in the log
+  // directory.
+  void createJobs() {
+    std::size_t numCombinations = 1;
+    for (const auto &[name, values] : sweep)
+      numCombinations *= values.size();
+
+    for (const auto &config : configFiles) {
+      if (sweep.empty()) {
+        Job job;
+        job.name = jobName(jobs.size(), config);
+        job.configFile = config;
+        jobs.push_back(job);
+        continue;
+      }
+
+      std::ifstream file(config);
+      if (!file.is_open()) {
+        Logger::getInstance()
+            .addError("Could not open input file '" + config + "'.")
+            .print();
+        continue;
+      }
+      std::stringstream buffer;
+      buffer << file.rdbuf();
+      const std::string content = buffer.str();
+
+      for (const auto &[name, values] : sweep)
+        if (content.find("${" + name + "}") == std::string::npos)
+          Logger::getInstance()
+              .addWarning("Sweep placeholder ${" + name +
+                          "} is not used in '" + config + "'.")
+              .print();
+
+      for (std::size_t c = 0; c < numCombinations; ++c) {
+        Job job;
+        job.name = jobName(jobs.size(), config);
+        std::string jobContent = replaceAll(content, "${job}", job.name);
+        // Decompose the combination index, the last sweep varies fastest
+        std::size_t index = c;
+        std::string parameters;
+        for (auto it = sweep.rbegin(); it != sweep.rend(); ++it) {
+          const auto &value = it->second[index % it->second.size()];
+          index /= it->second.size();
+          jobContent = replaceAll(jobContent, "${" + it->first + "}", value);
+          parameters = it->first + "=" + value +
+                       (parameters.empty() ? "" : " ") + parameters;
+        }
+        job.parameters = parameters;
+        job.configFile = logDir + "/" + job.name + ".txt";
+        std::ofstream(job.configFile) << jobContent;
+        jobs.push_back(job);
+      }
+    }
+  }
+
+  // Runs the job in the current process. Returns the exit code of the job.
+  int runJob(const Job &job) {
+#ifdef _OPENMP
+    omp_set_num_threads(numThreads);
+#endif
+    try {
+      Application<D> app(job.configFile);
+      if (!cacheDir.empty())
+        app.setCacheDirectory(cacheDir);
+      if (!benchmarkFormat.empty())
+        app.setBenchmarkFile(logDir + "/" + job.name + ".benchmark." +
+                             benchmarkFormat);
+      const int status = app.run();
+      std::cout.flush();
+      return status;
+    } catch (const std::exception &e) {
+      std::cerr << "Job failed: " << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  void reportFinished(const Job &job, std::size_t numFinished) const {
+    std::cout << "[" << numFinished << "/" << jobs.size() << "] " << job.name
+              << (job.status == 0 ? " finished" : " FAILED") << " after "
+              << std::fixed << std::setprecision(2) << job.time << " s"
+              << std::endl;
+  }
+
+#ifndef _WIN32
+  // Runs the job in a child process with the output redirected to its log
+  // file. Returns the process id of the child.
+  pid_t startJob(const Job &job) {
+    // Flush the buffers, otherwise their content is duplicated in the child
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    pid_t pid = fork();
+    if (pid != 0)
+      return pid;
+
+    int fd = ::open(job.logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      _exit(127);
+    ::dup2(fd, STDOUT_FILENO);
+    ::dup2(fd, STDERR_FILENO);
+    ::close(fd);
+
+    const int status = runJob(job);
+    std::fflush(nullptr);
+    _exit(status);
+  }
+
+  void execute() {
+    std::map<pid_t, std::size_t> running;
+    std::vector<Clock::time_point> startTimes(jobs.size());
+    std::size_t next = 0;
+    std::size_t numFinished = 0;
+
+    while (numFinished < jobs.size()) {
+      // Keep the pool filled
+      while (running.size() < static_cast<std::size_t>(numJobs) &&
+             next < jobs.size()) {
+        pid_t pid = startJob(jobs[next]);
+        if (pid < 0) {
+          Logger::getInstance()
+              .addWarning("Could not start job " + jobs[next].name + ".")
+              .print();
+          reportFinished(jobs[next++], ++numFinished);
+          continue;
+        }
+        startTimes[next] = Clock::now();
+        running.insert({pid, next++});
+      }
+      if (running.empty())
+        continue;
+
+      int status = 0;
+      pid_t pid = waitpid(-1, &status, 0);
+      if (pid < 0)
+        break;
+      auto it = running.find(pid);
+      if (it == running.end())
+        continue;
+
+      auto &job = jobs[it->second];
+      job.time = std::chrono::duration<double>(Clock::now() -
+                                               startTimes[it->second])
+                     .count();
+      if (WIFEXITED(status))
+        job.status = WEXITSTATUS(status);
+      else if (WIFSIGNALED(status))
+        job.status = 128 + WTERMSIG(status);
+      running.erase(it);
+      reportFinished(job, ++numFinished);
+    }
+  }
+#else
+  // Without fork, the jobs are run one after another in this process and
+  // their output is not redirected.
+  void execute() {
+    Logger::getInstance()
+        .addWarning("Jobs are run sequentially on this platform.")
+        .print();
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t numFinished = 0;
+    for (auto &job : jobs) {
+      job.logFile = "-";
+      auto start = Clock::now();
+      job.status = runJob(job);
+      job.time = std::chrono::duration<double>(Clock::now() - start).count();
+      reportFinished(job, ++numFinished);
+    }
+  }
+#endif
+
+  void printSummary(std::ostream &out) const {
+    std::size_t nameWidth = 4;
+    for (const auto &job : jobs)
+      nameWidth = std::max(nameWidth, job.name.size());
+
+    out << "\nSummary:\n"
+        << std::left << std::setw(nameWidth + 2) << "Job" << std::setw(10)
+        << "Status" << std::right << std::setw(10) << "Time [s]" << "  "
+        << "Parameters\n";
+    for (const auto &job : jobs) {
+      std::string status =
+          job.status == 0 ? "OK" : "FAILED(" + std::to_string(job.status) + ")";
+      out << std::left << std::setw(nameWidth + 2) << job.name << std::setw(10)
+          << status << std::right << std::setw(10) << std::fixed
+          << std::setprecision(2) << job.time << "  " << job.parameters
+          << "\n";
+    }
+  }
+
+  void writeSummary(const std::string &fileName) const {
+    std::ofstream file(fileName);
+    file << "job,config,parameters,status,time,log\n";
+    for (const auto &job : jobs)
+      file << job.name << ',' << job.configFile << ",\"" << job.parameters
+           << "\"," << job.status << ',' << job.time << ',' << job.logFile
+           << '\n';
+  }
+
+public:
+  ApplicationRunner(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "-h" || arg == "--help") {
+        printUsage();
+        std::exit(0);
+      }
+
+      if (arg.size() > 1 && arg[0] == '-') {
+        if (i + 1 >= argc) {
+          Logger::getInstance()
+              .addError("Missing value for option " + arg)
+              .print();
+          return;
+        }
+        const std::string value = argv[++i];
+        if (arg == "-j" || arg == "--jobs") {
+          numJobs = parseCount(arg, value);
+        } else if (arg == "-t" || arg == "--threads") {
+          numThreads = parseCount(arg, value);
+        } else if (arg == "-s" || arg == "--sweep") {
+          parseSweep(value);
+        } else if (arg == "-l" || arg == "--log-dir") {
+          logDir = value;
+        } else if (arg == "-c" || arg == "--cache") {
+          cacheDir = value;
+        } else if (arg == "-b" || arg == "--benchmark") {
+          if (value != "json" && value != "csv")
+            Logger::getInstance()
+                .addError("Invalid benchmark format '" + value +
+                          "', expected json or csv")
+                .print();
+          benchmarkFormat = value;
+        } else {
+          Logger::getInstance().addError("Unknown option " + arg).print();
+        }
+        batchMode = true;
+      } else {
+        configFiles.push_back(arg);
+      }
+    }
+    if (configFiles.size() > 1)
+      batchMode = true;
+  }
+
+  // Returns the exit code of the application: 0 if all jobs succeeded.
+  int run() {
+    if (configFiles.empty()) {
+      printUsage();
+      Logger::getInstance().addError("No input file specified.").print();
+      return 1;
+    }
+
+    if (!batchMode) {
+      Application<D> app(configFiles.front());
+      return app.run();
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(logDir, ec);
+    if (ec) {
+      Logger::getInstance()
+          .addError("Could not create log directory '" + logDir + "'.")
+          .print();
+      return 1;
+    }
+
+    createJobs();
+    if (jobs.empty())
+      return 1;
+    for (auto &job : jobs)
+      job.logFile = logDir + "/" + job.name + ".log";
+
+    const int numCores =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    if (numJobs == 0)
+      numJobs = numThreads > 0 ? std::max(1, numCores / numThreads) : numCores;
+    numJobs = std::min(numJobs, static_cast<int>(jobs.size()));
+    if (numThreads == 0)
+      numThreads = std::max(1, numCores / numJobs);
+
+    std::cout << "Running " << jobs.size() << " jobs, " << numJobs
+              << " at a time with " << numThreads
+              << " threads each. Logs are written to '" << logDir << "'.\n";
+
+    execute();
+
+    printSummary(std::cout);
+    writeSummary(logDir + "/summary.csv");
+
+    const auto numFailed =
+        std::count_if(jobs.begin(), jobs.end(),
+                      [](const Job &job) { return job.status != 0; });
+    std::cout << "\n"
+              << jobs.size() - numFailed << " of " << jobs.size()
+              << " jobs succeeded.\n";
+    return numFailed == 0 ? 0 : 1;
+  }
+};
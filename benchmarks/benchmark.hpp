@@ -0,0 +1,470 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <psProcess.hpp>
+
+using namespace viennaps;
+
+// Work done by a single run of a workload. The throughputs reported by the
+// benchmark suite are computed from it.
+struct BenchmarkWork {
+  // Surface or level set points processed
+  std::size_t points = 0;
+  std::size_t rays = 0;
+  // Time steps or cycles
+  std::size_t steps = 0;
+
+  // Time spent in the phases of a process
+  double rayTracingTime = 0.;
+  double advectionTime = 0.;
+  double surfaceModelTime = 0.;
+  double meshConversionTime = 0.;
+
+  BenchmarkWork &operator+=(const BenchmarkWork &other) {
+    points += other.points;
+    rays += other.rays;
+    steps += other.steps;
+    rayTracingTime += other.rayTracingTime;
+    advectionTime += other.advectionTime;
+    surfaceModelTime += other.surfaceModelTime;
+    meshConversionTime += other.meshConversionTime;
+    return *this;
+  }
+};
+
+// Work done by a process, taken from its statistics.
+inline BenchmarkWork processWork(const ProcessStatistics &statistics) {
+  BenchmarkWork work;
+  for (const auto &step : statistics.steps) {
+    work.points += step.numSurfacePoints;
+    for (auto rays : step.raysTraced)
+      work.rays += rays;
+    for (auto time : step.tracingTimes)
+      work.rayTracingTime += time;
+    work.advectionTime += step.advectionTime;
+    work.surfaceModelTime += step.surfaceModelTime;
+    work.meshConversionTime += step.diskMeshTime;
+  }
+  work.steps = statistics.steps.size();
+  return work;
+}
+
+// A workload is set up for a size (0 is the smallest) and returns the
+// function which is timed. The setup, e.g. creating the initial geometry, is
+// repeated for every run and not part of the measured time.
+using BenchmarkWorkload =
+    std::function<std::function<BenchmarkWork()>(unsigned size)>;
+
+// Runs registered workloads at several sizes, with warm-up runs and repeated
+// measurements, and reports the run times and throughputs. If several thread
+// counts are given, every workload is run with each of them and the speedup
+// and parallel efficiency of the total run time and of each process phase are
+// reported as well.
+class BenchmarkSuite {
+  struct Case {
+    std::string name;
+    BenchmarkWorkload workload;
+  };
+
+  struct Result {
+    std::string name;
+    std::string size;
+    int threads = 1;
+    std::vector<double> times;
+    // Sum over all measured runs
+    BenchmarkWork work;
+
+    double totalTime() const {
+      double total = 0.;
+      for (auto t : times)
+        total += t;
+      return total;
+    }
+
+    double meanTime() const { return totalTime() / times.size(); }
+
+    double minTime() const {
+      return *std::min_element(times.begin(), times.end());
+    }
+
+    double stdDevTime() const {
+      const double mean = meanTime();
+      double sum = 0.;
+      for (auto t : times)
+        sum += (t - mean) * (t - mean);
+      return times.size() > 1 ? std::sqrt(sum / (times.size() - 1)) : 0.;
+    }
+
+    double rate(std::size_t count) const {
+      const double total = totalTime();
+      return total > 0. ? count / total : 0.;
+    }
+  };
+
+  const std::vector<std::string> sizeNames = {"small", "medium", "large"};
+
+  std::vector<Case> cases;
+  std::vector<unsigned> sizes = {0, 1, 2};
+  std::vector<std::string> filters;
+  // Empty to use the default number of threads
+  std::vector<int> threadCounts;
+  unsigned warmup = 1;
+  unsigned repetitions = 3;
+  std::string outputFile;
+  std::string scalingFile;
+  bool listOnly = false;
+
+  // Phases of a process whose scaling is reported, in addition to the total
+  // run time
+  struct Phase {
+    const char *name;
+    double BenchmarkWork::*time;
+  };
+  static constexpr Phase phases[] = {
+      {"rayTracing", &BenchmarkWork::rayTracingTime},
+      {"advection", &BenchmarkWork::advectionTime},
+      {"surfaceModel", &BenchmarkWork::surfaceModelTime},
+      {"meshConversion", &BenchmarkWork::meshConversionTime}};
+
+  static void printUsage() {
+    std::cout
+        << "Usage: ViennaPS_Benchmarks [options]\n"
+        << "Options:\n"
+        << "  -f, --filter <name>     only run benchmarks whose name contains\n"
+        << "                          <name>, can be given multiple times\n"
+        << "  -s, --sizes <a,b>       sizes to run: small, medium, large\n"
+        << "  -r, --repetitions <n>   measured runs per benchmark and size\n"
+        << "  -w, --warmup <n>        unmeasured runs before the measurement\n"
+        << "  -t, --threads <a,b>     run every benchmark with each number of\n"
+        << "                          threads and report the scaling\n"
+        << "  -o, --output <file>     write the results as CSV\n"
+        << "  --scaling <file>        write the speedup and efficiency per\n"
+        << "                          phase as CSV\n"
+        << "  -l, --list              list the benchmarks and exit\n"
+        << "  -h, --help              print this message\n";
+  }
+
+  static unsigned parseCount(const std::string &option,
+                             const std::string &value) {
+    try {
+      return std::stoul(value);
+    } catch (...) {
+      Logger::getInstance()
+          .addError("Invalid value '" + value + "' for option " + option)
+          .print();
+    }
+    return 0;
+  }
+
+  void parseSizes(const std::string &value) {
+    sizes.clear();
+    std::istringstream stream(value);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+      auto it = std::find(sizeNames.begin(), sizeNames.end(), name);
+      if (it == sizeNames.end()) {
+        Logger::getInstance()
+            .addError("Unknown benchmark size '" + name + "'")
+            .print();
+        continue;
+      }
+      sizes.push_back(std::distance(sizeNames.begin(), it));
+    }
+  }
+
+  void parseThreads(const std::string &option, const std::string &value) {
+    threadCounts.clear();
+    std::istringstream stream(value);
+    std::string count;
+    while (std::getline(stream, count, ','))
+      threadCounts.push_back(std::max(1u, parseCount(option, count)));
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()),
+                       threadCounts.end());
+  }
+
+  bool isSelected(const std::string &name) const {
+    if (filters.empty())
+      return true;
+    for (const auto &filter : filters)
+      if (name.find(filter) != std::string::npos)
+        return true;
+    return false;
+  }
+
+  static int numThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  static void setNumThreads(int threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+  }
+
+  Result measure(const Case &benchmark, unsigned size, int threads) const {
+    setNumThreads(threads);
+
+    Result result;
+    result.name = benchmark.name;
+    result.size = sizeNames[size];
+    result.threads = threads;
+
+    for (unsigned i = 0; i < warmup + repetitions; ++i) {
+      auto run = benchmark.workload(size);
+
+      Timer timer;
+      timer.start();
+      const auto work = run();
+      timer.finish();
+
+      if (i < warmup)
+        continue;
+      result.times.push_back(timer.currentDuration * 1e-9);
+      result.work += work;
+    }
+    return result;
+  }
+
+  static void printHeader() {
+    std::cout << std::left << std::setw(24) << "benchmark" << std::setw(8)
+              << "size" << std::right << std::setw(8) << "threads"
+              << std::setw(12) << "mean [s]"
+              << std::setw(12) << "min [s]" << std::setw(12) << "stddev [s]"
+              << std::setw(14) << "points/s" << std::setw(14) << "rays/s"
+              << std::setw(12) << "steps/s" << '\n';
+  }
+
+  static void printResult(const Result &result) {
+    // Throughputs of work that a benchmark does not do are not printed
+    auto rate = [&result](std::size_t count) {
+      std::ostringstream stream;
+      if (count > 0)
+        stream << std::setprecision(4) << result.rate(count);
+      else
+        stream << '-';
+      return stream.str();
+    };
+    std::cout << std::left << std::setw(24) << result.name << std::setw(8)
+              << result.size << std::right << std::setw(8) << result.threads
+              << std::fixed << std::setprecision(4) << std::setw(12)
+              << result.meanTime()
+              << std::setw(12) << result.minTime() << std::setw(12)
+              << result.stdDevTime() << std::defaultfloat << std::setw(14)
+              << rate(result.work.points) << std::setw(14)
+              << rate(result.work.rays) << std::setw(12)
+              << rate(result.work.steps) << std::endl;
+  }
+
+  bool writeCSV(const std::vector<Result> &results) const {
+    std::ofstream file(outputFile);
+    if (!file.is_open()) {
+      Logger::getInstance()
+          .addWarning("Could not write benchmark results '" + outputFile +
+                      "'.")
+          .print();
+      return false;
+    }
+    file << std::setprecision(9);
+    file << "benchmark,size,threads,warmup,repetitions,meanTime,minTime,"
+            "stdDevTime,points,rays,steps,pointsPerSecond,raysPerSecond,"
+            "stepsPerSecond";
+    for (const auto &phase : phases)
+      file << ',' << phase.name << "Time";
+    file << '\n';
+    for (const auto &result : results) {
+      const auto runs = result.times.size();
+      file << result.name << ',' << result.size << ',' << result.threads << ','
+           << warmup << ',' << runs << ',' << result.meanTime() << ','
+           << result.minTime() << ',' << result.stdDevTime() << ','
+           << result.work.points / runs << ',' << result.work.rays / runs
+           << ',' << result.work.steps / runs << ','
+           << result.rate(result.work.points) << ','
+           << result.rate(result.work.rays) << ','
+           << result.rate(result.work.steps);
+      for (const auto &phase : phases)
+        file << ',' << result.work.*phase.time / runs;
+      file << '\n';
+    }
+    return true;
+  }
+
+  // Scaling of the total time and of each phase of a group of results that
+  // only differ in the number of threads, relative to the result with the
+  // fewest threads. Phases that a workload does not run are omitted.
+  template <class Fn>
+  static void forEachScaling(const std::vector<Result> &group, Fn fn) {
+    const auto &base = group.front();
+    auto scaling = [&](const char *phase, auto time) {
+      if (!(time(base) > 0.))
+        return;
+      for (const auto &result : group) {
+        const double speedup = time(result) > 0. ? time(base) / time(result)
+                                                 : 0.;
+        const double efficiency = speedup * base.threads / result.threads;
+        fn(result, phase, time(result), speedup, efficiency);
+      }
+    };
+
+    scaling("total", [](const Result &r) { return r.meanTime(); });
+    for (const auto &phase : phases)
+      scaling(phase.name, [&phase](const Result &r) {
+        return r.work.*phase.time / r.times.size();
+      });
+  }
+
+  void printScaling(const std::vector<Result> &group) const {
+    std::cout << "\nScaling of " << group.front().name << " ("
+              << group.front().size << ")\n"
+              << std::left << std::setw(16) << "phase" << std::right
+              << std::setw(8) << "threads" << std::setw(12) << "mean [s]"
+              << std::setw(10) << "speedup" << std::setw(12) << "efficiency"
+              << '\n';
+    forEachScaling(group, [](const Result &result, const char *phase,
+                             double time, double speedup, double efficiency) {
+      std::cout << std::left << std::setw(16) << phase << std::right
+                << std::setw(8) << result.threads << std::fixed
+                << std::setprecision(4) << std::setw(12) << time
+                << std::setprecision(2) << std::setw(10) << speedup
+                << std::setw(12) << efficiency << std::defaultfloat << '\n';
+    });
+  }
+
+  // One row per benchmark, size, phase and number of threads
+  bool writeScalingCSV(const std::vector<std::vector<Result>> &groups) const {
+    std::ofstream file(scalingFile);
+    if (!file.is_open()) {
+      Logger::getInstance()
+          .addWarning("Could not write scaling results '" + scalingFile +
+                      "'.")
+          .print();
+      return false;
+    }
+    file << std::setprecision(9);
+    file << "benchmark,size,phase,threads,meanTime,speedup,efficiency\n";
+    for (const auto &group : groups)
+      forEachScaling(group, [&file](const Result &result, const char *phase,
+                                    double time, double speedup,
+                                    double efficiency) {
+        file << result.name << ',' << result.size << ',' << phase << ','
+             << result.threads << ',' << time << ',' << speedup << ','
+             << efficiency << '\n';
+      });
+    return true;
+  }
+
+public:
+  BenchmarkSuite(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "-h" || arg == "--help") {
+        printUsage();
+        std::exit(0);
+      } else if (arg == "-l" || arg == "--list") {
+        listOnly = true;
+        continue;
+      }
+
+      if (i + 1 >= argc) {
+        printUsage();
+        Logger::getInstance()
+            .addError("Missing value for option " + arg)
+            .print();
+        std::exit(1);
+      }
+      const std::string value = argv[++i];
+      if (arg == "-f" || arg == "--filter") {
+        filters.push_back(value);
+      } else if (arg == "-s" || arg == "--sizes") {
+        parseSizes(value);
+      } else if (arg == "-r" || arg == "--repetitions") {
+        repetitions = std::max(1u, parseCount(arg, value));
+      } else if (arg == "-w" || arg == "--warmup") {
+        warmup = parseCount(arg, value);
+      } else if (arg == "-t" || arg == "--threads") {
+        parseThreads(arg, value);
+      } else if (arg == "-o" || arg == "--output") {
+        outputFile = value;
+      } else if (arg == "--scaling") {
+        scalingFile = value;
+      } else {
+        Logger::getInstance().addError("Unknown option " + arg).print();
+      }
+    }
+  }
+
+  void add(const std::string &name, BenchmarkWorkload workload) {
+    cases.push_back({name, std::move(workload)});
+  }
+
+  // Returns the exit code of the benchmark executable.
+  int run() {
+    std::vector<const Case *> selected;
+    for (const auto &benchmark : cases)
+      if (isSelected(benchmark.name))
+        selected.push_back(&benchmark);
+
+    if (selected.empty()) {
+      Logger::getInstance()
+          .addWarning("No benchmark matches the given filters.")
+          .print();
+      return 1;
+    }
+
+    if (listOnly) {
+      for (const auto benchmark : selected)
+        std::cout << benchmark->name << '\n';
+      return 0;
+    }
+
+    const auto threads =
+        threadCounts.empty() ? std::vector<int>{numThreads()} : threadCounts;
+
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency()
+              << ", warm-up runs: " << warmup
+              << ", repetitions: " << repetitions << "\n\n";
+    printHeader();
+
+    std::vector<Result> results;
+    std::vector<std::vector<Result>> groups;
+    for (const auto benchmark : selected)
+      for (auto size : sizes) {
+        auto &group = groups.emplace_back();
+        for (auto numThreads : threads) {
+          group.push_back(measure(*benchmark, size, numThreads));
+          printResult(group.back());
+          results.push_back(group.back());
+        }
+      }
+
+    if (threads.size() > 1)
+      for (const auto &group : groups)
+        printScaling(group);
+
+    bool success = true;
+    if (!outputFile.empty())
+      success &= writeCSV(results);
+    if (!scalingFile.empty())
+      success &= writeScalingCSV(groups);
+    return success ? 0 : 1;
+  }
+};
@@ -0,0 +1,170 @@
+#include <geometries/psMakeHole.hpp>
+#include <geometries/psMakeStack.hpp>
+#include <geometries/psMakeTrench.hpp>
+#include <models/psFluorocarbonEtching.hpp>
+#include <models/psSF6O2Etching.hpp>
+#include <models/psSingleParticleALD.hpp>
+#include <models/psSingleParticleProcess.hpp>
+
+#include <psAtomicLayerProcess.hpp>
+#include <psConstants.hpp>
+#include <psDomain.hpp>
+#include <psGDSReader.hpp>
+#include <psProcess.hpp>
+
+#include "benchmark.hpp"
+
+using NumericType = double;
+
+// Each size halves the grid delta of the previous one.
+static NumericType refine(NumericType gridDelta, unsigned size) {
+  return gridDelta / (1 << size);
+}
+
+template <int D>
+static std::size_t
+numberOfPoints(SmartPointer<Domain<NumericType, D>> domain) {
+  return domain->getLevelSets().back()->getNumberOfPoints();
+}
+
+template <int D>
+static SmartPointer<Domain<NumericType, D>> makeHoleGeometry(unsigned size) {
+  auto domain = SmartPointer<Domain<NumericType, D>>::New();
+  MakeHole<NumericType, D>(domain, refine(2., size), 50., 50., 10., 10., 0.,
+                           0., false, true, Material::Si)
+      .apply();
+  return domain;
+}
+
+// Trench deposition with a single particle species
+static auto trenchDeposition(unsigned size) {
+  constexpr int D = 3;
+  auto domain = SmartPointer<Domain<NumericType, D>>::New();
+  MakeTrench<NumericType, D>(domain, refine(0.5, size), 10., 10., 4., 8.)
+      .apply();
+  domain->duplicateTopLevelSet(Material::SiO2);
+
+  auto model =
+      SmartPointer<SingleParticleProcess<NumericType, D>>::New(1., 0.1, 1.);
+  auto process = SmartPointer<Process<NumericType, D>>::New(domain, model, 2.);
+  process->setNumberOfRaysPerPoint(500);
+
+  return [process]() {
+    process->apply();
+    return processWork(process->getStatistics());
+  };
+}
+
+// Hole etching with the SF6O2 model
+static auto holeEtching(unsigned size) {
+  constexpr int D = 3;
+  auto domain = makeHoleGeometry<D>(size);
+
+  auto model = SmartPointer<SF6O2Etching<NumericType, D>>::New(
+      1., 180., 30., 100., 10., 200., 3.);
+  auto process = SmartPointer<Process<NumericType, D>>::New(domain, model, 10.);
+  process->setMaxCoverageInitIterations(10);
+  process->setNumberOfRaysPerPoint(500);
+
+  return [process]() {
+    process->apply();
+    return processWork(process->getStatistics());
+  };
+}
+
+// Etching of an alternating layer stack with the fluorocarbon model
+static auto stackEtching(unsigned size) {
+  constexpr int D = 2;
+  auto domain = SmartPointer<Domain<NumericType, D>>::New();
+  MakeStack<NumericType, D>(domain, refine(2., size), 120., 120., 5, 30., 50.,
+                            0., 75., 50., false)
+      .apply();
+  domain->duplicateTopLevelSet(Material::Polymer);
+
+  auto model = SmartPointer<FluorocarbonEtching<NumericType, D>>::New(
+      56., 150., 10., 100., 10.);
+  auto process = SmartPointer<Process<NumericType, D>>::New(domain, model, 5.);
+  process->setMaxCoverageInitIterations(10);
+  process->setTimeStepRatio(0.25);
+
+  return [process]() {
+    process->apply();
+    return processWork(process->getStatistics());
+  };
+}
+
+// Atomic layer deposition cycles in a trench
+static auto atomicLayerDeposition(unsigned size) {
+  constexpr int D = 2;
+  constexpr unsigned numCycles = 4;
+  auto domain = SmartPointer<Domain<NumericType, D>>::New();
+  MakeTrench<NumericType, D>(domain, refine(0.1, size), 5., 5., 2., 4.)
+      .apply();
+  domain->duplicateTopLevelSet(Material::Al2O3);
+
+  const NumericType gasMFP = constants::gasMeanFreePath(0.1, 220., 2.75);
+  auto model = SmartPointer<SingleParticleALD<NumericType, D>>::New(
+      5e-5, numCycles, 0.000112, 400, 0.01, 0., 2e6, 3.36, gasMFP);
+  auto process =
+      SmartPointer<AtomicLayerProcess<NumericType, D>>::New(domain, model);
+  process->setCoverageTimeStep(0.01);
+  process->setPulseTime(0.1);
+  process->setNumCycles(numCycles);
+  process->setNumberOfRaysPerPoint(100);
+  process->disableRandomSeeds();
+
+  return [domain, process]() {
+    process->apply();
+    BenchmarkWork work;
+    work.points = numberOfPoints(domain);
+    work.steps = numCycles;
+    return work;
+  };
+}
+
+// Reading a GDS file and converting its layers to level sets
+static auto gdsImport(unsigned size) {
+  constexpr int D = 3;
+  const NumericType gridDelta = refine(0.02, size);
+
+  return [gridDelta]() {
+    viennals::BoundaryConditionEnum<D> boundaryConditions[D] = {
+        viennals::BoundaryConditionEnum<D>::REFLECTIVE_BOUNDARY,
+        viennals::BoundaryConditionEnum<D>::REFLECTIVE_BOUNDARY,
+        viennals::BoundaryConditionEnum<D>::INFINITE_BOUNDARY};
+    auto mask = SmartPointer<GDSGeometry<NumericType, D>>::New(gridDelta);
+    mask->setBoundaryConditions(boundaryConditions);
+    GDSReader<NumericType, D>(mask, "mask.gds").apply();
+
+    BenchmarkWork work;
+    work.points += mask->layerToLevelSet(0, 0., 0.1)->getNumberOfPoints();
+    work.points += mask->layerToLevelSet(1, -0.15, 0.45)->getNumberOfPoints();
+    return work;
+  };
+}
+
+// Writing the surface mesh of a hole geometry
+static auto saveSurfaceMesh(unsigned size) {
+  constexpr int D = 3;
+  auto domain = makeHoleGeometry<D>(size);
+
+  return [domain]() {
+    domain->saveSurfaceMesh("benchmarkSurface.vtp");
+    BenchmarkWork work;
+    work.points = numberOfPoints(domain);
+    return work;
+  };
+}
+
+int main(int argc, char **argv) {
+  Logger::setLogLevel(LogLevel::WARNING);
+
+  BenchmarkSuite suite(argc, argv);
+  suite.add("trenchDeposition", trenchDeposition);
+  suite.add("holeEtching", holeEtching);
+  suite.add("stackEtching", stackEtching);
+  suite.add("atomicLayerDeposition", atomicLayerDeposition);
+  suite.add("gdsImport", gdsImport);
+  suite.add("saveSurfaceMesh", saveSurfaceMesh);
+  return suite.run();
+}
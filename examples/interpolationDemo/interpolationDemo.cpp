@@ -6,6 +6,7 @@
  * extrapolation outside of the provided domain (by calling the constructor with
  * `true`)
  */
+#include <cmath>
 #include <filesystem>
 #include <iostream>
 #include <string>
@@ -26,22 +27,30 @@ void doEstimation(DataSource &dataSource, Estimator &estimator,
                   SizeType numSamples, SizeType InputDim) {
   using NumericType = typename DataSource::ItemType::value_type;
   if (estimator.initialize()) {
-    std::vector<std::vector<NumericType>> data;
+    // Set up all query points at once and evaluate them in a single batch
+    const SizeType numPoints = numSamples * numSamples;
+    const SizeType OutputDim = estimator.getOutputDimension();
+    std::vector<NumericType> inputs(numPoints * InputDim, 0.);
+    std::vector<NumericType> outputs(numPoints * OutputDim);
     for (int i = 0; i < numSamples; ++i)
       for (int j = 0; j < numSamples; ++j) {
-        std::vector<NumericType> x(InputDim);
+        auto x = &inputs[(i * numSamples + j) * InputDim];
         // Extrapolate
         x[0] = .1 + i * (.8 - .1) / (numSamples - 1);
         x[1] = -6. + j * (8. + 6.) / (numSamples - 1);
+      }
 
-        auto estimateOpt = estimator.estimate(x);
-        if (!estimateOpt)
-          continue;
+    estimator.estimateBatch(inputs.data(), numPoints, outputs.data());
 
-        // We use structural bindings to directly unpack the tuple
-        auto [value, _] = estimateOpt.value();
-        data.emplace_back(std::vector{x[0], x[1], value[0]});
-      }
+    std::vector<std::vector<NumericType>> data;
+    for (SizeType n = 0; n < numPoints; ++n) {
+      // Points for which the estimation failed are set to NaN
+      if (std::isnan(outputs[n * OutputDim]))
+        continue;
+      data.emplace_back(std::vector{inputs[n * InputDim],
+                                    inputs[n * InputDim + 1],
+                                    outputs[n * OutputDim]});
+    }
     dataSource.setData(data);
     dataSource.sync();
   }
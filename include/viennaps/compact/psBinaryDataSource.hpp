@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../psMappedFile.hpp"
+#include "psDataSource.hpp"
+#include "psDataView.hpp"
+
+#include <vcLogger.hpp>
+
+namespace viennaps {
+
+using namespace viennacore;
+
+// Data source storing the data in a binary, column-wise file. The file starts
+// with a small header containing the data dimensions and the positional and
+// named parameters, followed by one contiguous block holding all columns.
+// Files are memory-mapped on loading, so getView() gives direct access to the
+// data without copying it.
+template <typename NumericType>
+class BinaryDataSource : public DataSource<NumericType> {
+  using Parent = DataSource<NumericType>;
+
+  using Parent::namedParameters;
+  using Parent::positionalParameters;
+
+  static_assert(std::is_same_v<NumericType, float> ||
+                    std::is_same_v<NumericType, double>,
+                "BinaryDataSource: NumericType has to be float or double.");
+
+  static constexpr char magic[8] = {'V', 'i', 'e', 'n', 'n', 'a', 'P', 'S'};
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t byteOrderMark = 0x01020304;
+  // The data block starts at a multiple of this offset
+  static constexpr std::size_t dataAlignment = 64;
+
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t valueSize;
+    uint32_t numPositional;
+    uint64_t numRows;
+    uint64_t numCols;
+    uint32_t numNamed;
+    uint32_t reserved;
+  };
+
+  std::string filename;
+  DataView<NumericType> view;
+  bool loaded = false;
+
+  template <class T>
+  static bool readRaw(const unsigned char *&pos, const unsigned char *end,
+                      T &value) {
+    if (static_cast<std::size_t>(end - pos) < sizeof(T))
+      return false;
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+  }
+
+  // Reads a single value stored with the given size, converting it to
+  // NumericType.
+  static bool readValue(const unsigned char *&pos, const unsigned char *end,
+                        uint32_t valueSize, NumericType &value) {
+    if (valueSize == sizeof(float)) {
+      float v;
+      if (!readRaw(pos, end, v))
+        return false;
+      value = static_cast<NumericType>(v);
+    } else {
+      double v;
+      if (!readRaw(pos, end, v))
+        return false;
+      value = static_cast<NumericType>(v);
+    }
+    return true;
+  }
+
+  static std::size_t alignOffset(std::size_t offset) {
+    return (offset + dataAlignment - 1) / dataAlignment * dataAlignment;
+  }
+
+  bool fail(const std::string &message) const {
+    Logger::getInstance()
+        .addWarning("BinaryDataSource: " + message + " in '" + filename + "'")
+        .print();
+    return false;
+  }
+
+  bool load() {
+    if (loaded)
+      return true;
+
+    auto file = std::make_shared<utils::MappedFile>();
+    if (!file->open(filename))
+      return fail("Couldn't open file");
+
+    const unsigned char *begin = file->data();
+    const unsigned char *end = begin + file->size();
+    const unsigned char *pos = begin;
+
+    FileHeader header;
+    if (!readRaw(pos, end, header) ||
+        std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+      return fail("Invalid file signature");
+    if (header.version != version)
+      return fail("Unsupported file version " +
+                  std::to_string(header.version));
+    if (header.byteOrder != byteOrderMark)
+      return fail("Byte order of the file does not match the host");
+    if (header.valueSize != sizeof(float) &&
+        header.valueSize != sizeof(double))
+      return fail("Unsupported value size " +
+                  std::to_string(header.valueSize));
+
+    std::vector<NumericType> positional(header.numPositional);
+    for (auto &value : positional)
+      if (!readValue(pos, end, header.valueSize, value))
+        return fail("Unexpected end of file");
+
+    std::unordered_map<std::string, NumericType> named;
+    for (uint32_t i = 0; i < header.numNamed; ++i) {
+      uint32_t length;
+      if (!readRaw(pos, end, length) ||
+          static_cast<std::size_t>(end - pos) < length)
+        return fail("Unexpected end of file");
+      std::string key(reinterpret_cast<const char *>(pos), length);
+      pos += length;
+      NumericType value;
+      if (!readValue(pos, end, header.valueSize, value))
+        return fail("Unexpected end of file");
+      named.insert({key, value});
+    }
+
+    if (header.numRows > SIZE_MAX ||
+        (header.numCols != 0 && header.numRows > SIZE_MAX / header.numCols))
+      return fail("Invalid data size");
+    const std::size_t dataOffset = alignOffset(pos - begin);
+    const std::size_t numValues = header.numRows * header.numCols;
+    if (dataOffset > file->size() ||
+        (file->size() - dataOffset) / header.valueSize < numValues)
+      return fail("Unexpected end of file");
+
+    const unsigned char *dataBlock = begin + dataOffset;
+    if (header.valueSize == sizeof(NumericType)) {
+      // Zero-copy: the view aliases the mapped file and keeps it alive
+      view = DataView<NumericType>::columnMajor(
+          reinterpret_cast<const NumericType *>(dataBlock), header.numRows,
+          header.numCols, file);
+    } else {
+      auto converted = std::make_shared<std::vector<NumericType>>(numValues);
+      auto &values = *converted;
+#pragma omp parallel for
+      for (long i = 0; i < static_cast<long>(numValues); ++i) {
+        const unsigned char *valuePos = dataBlock + i * header.valueSize;
+        readValue(valuePos, end, header.valueSize, values[i]);
+      }
+      view = DataView<NumericType>::columnMajor(
+          values.data(), header.numRows, header.numCols, converted);
+    }
+
+    positionalParameters = std::move(positional);
+    namedParameters = std::move(named);
+    loaded = true;
+    return true;
+  }
+
+public:
+  using typename Parent::ItemType;
+  using typename Parent::VectorType;
+
+  BinaryDataSource() {}
+
+  BinaryDataSource(std::string passedFilename) : filename(passedFilename) {}
+
+  void setFilename(std::string passedFilename) {
+    filename = passedFilename;
+    view = DataView<NumericType>();
+    loaded = false;
+  }
+
+  // Returns a view of the data stored in the file without copying it. The
+  // view stays valid after the data source is modified or destroyed.
+  DataView<NumericType> getView() {
+    if (!load())
+      return {};
+    return view;
+  }
+
+  std::vector<NumericType> getPositionalParameters() override {
+    load();
+    return positionalParameters;
+  }
+
+  std::unordered_map<std::string, NumericType> getNamedParameters() override {
+    load();
+    return namedParameters;
+  }
+
+protected:
+  VectorType read() override {
+    if (!load())
+      return {};
+    return view.toRows();
+  }
+
+  bool write(const VectorType &data) override {
+    const std::size_t numRows = data.size();
+    const std::size_t numCols = numRows > 0 ? data[0].size() : 0;
+    for (const auto &row : data)
+      if (row.size() != numCols)
+        return fail("Unexpected number of items in a row");
+
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byteOrder = byteOrderMark;
+    header.valueSize = sizeof(NumericType);
+    header.numPositional = static_cast<uint32_t>(positionalParameters.size());
+    header.numRows = numRows;
+    header.numCols = numCols;
+    header.numNamed = static_cast<uint32_t>(namedParameters.size());
+
+    std::string buffer(reinterpret_cast<const char *>(&header),
+                       sizeof(header));
+    buffer.append(reinterpret_cast<const char *>(positionalParameters.data()),
+                  positionalParameters.size() * sizeof(NumericType));
+    for (const auto &[key, value] : namedParameters) {
+      const auto length = static_cast<uint32_t>(key.size());
+      buffer.append(reinterpret_cast<const char *>(&length), sizeof(length));
+      buffer.append(key);
+      buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    buffer.resize(alignOffset(buffer.size()), '\0');
+
+    // Transpose into the column-wise layout
+    std::vector<NumericType> columns(numRows * numCols);
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(numRows); ++i)
+      for (std::size_t j = 0; j < numCols; ++j)
+        columns[j * numRows + i] = data[i][j];
+
+    // Write to a temporary file first, so that views into the previous
+    // mapping of the file remain valid.
+    const std::string tmpName = filename + ".tmp";
+    {
+      std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+      if (!file.is_open())
+        return fail("Couldn't open file for writing");
+      file.write(buffer.data(), buffer.size());
+      file.write(reinterpret_cast<const char *>(columns.data()),
+                 columns.size() * sizeof(NumericType));
+      if (!file.good())
+        return fail("Error while writing");
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpName, filename, ec);
+    if (ec)
+      return fail("Couldn't replace file (" + ec.message() + ")");
+
+    view = DataView<NumericType>();
+    loaded = false;
+    return true;
+  }
+};
+
+} // namespace viennaps
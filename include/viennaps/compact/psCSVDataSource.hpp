@@ -156,6 +156,7 @@ public:
     for (auto &row : data)
       if (!writer.writeRow(row))
         return false;
+    writer.flush();
 
     return true;
   }
@@ -1,26 +1,176 @@
 #pragma once
 
-#include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <optional>
-#include <regex>
-#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "../psMappedFile.hpp"
 #include "../psUtils.hpp"
 
+#include <vcLogger.hpp>
+
 namespace viennaps {
 
 using namespace viennacore;
 
-// Simple class for reading CSV files
+// Simple class for reading CSV files. The file is memory-mapped and the data
+// section is parsed in parallel in line-aligned chunks.
 template <class NumericType> class CSVReader {
-  // Regex to find trailing and leading whitespaces
-  const std::regex wsRegex = std::regex("^ +| +$|( ) +");
+  using RowType = std::vector<NumericType>;
+
+  // Approximate number of bytes parsed by one task
+  static constexpr std::size_t chunkSize = 1 << 20;
 
   std::string filename;
   char delimiter = ',';
   int numCols = 0;
+  int errorLine = -1;
+
+  struct Chunk {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    std::vector<RowType> rows;
+    int numLines = 0;
+    int firstRowLine = -1;
+    int firstRowCols = 0;
+    // Local line index and kind of the first error in this chunk
+    int errorLine = -1;
+    bool conversionError = false;
+  };
+
+  static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+  static std::string_view trim(std::string_view line) {
+    std::size_t first = 0;
+    while (first < line.size() && isBlank(line[first]))
+      ++first;
+    std::size_t last = line.size();
+    while (last > first && isBlank(line[last - 1]))
+      --last;
+    return line.substr(first, last - first);
+  }
+
+  // Trims the line and collapses runs of spaces into a single space.
+  static std::string normalize(std::string_view line) {
+    line = trim(line);
+    std::string result;
+    result.reserve(line.size());
+    for (std::size_t i = 0; i < line.size(); ++i) {
+      if (line[i] == ' ' && i > 0 && line[i - 1] == ' ')
+        continue;
+      result.push_back(line[i]);
+    }
+    return result;
+  }
+
+  static bool parseValue(std::string_view token, NumericType &value) {
+    token = trim(token);
+    // std::from_chars does not accept an explicit plus sign
+    if (token.size() > 1 && token[0] == '+' && token[1] != '-')
+      token.remove_prefix(1);
+    if (token.empty())
+      return false;
+    const char *first = token.data();
+    const char *last = token.data() + token.size();
+#ifdef __cpp_lib_to_chars
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    return ec == std::errc() && ptr == last;
+#else
+    std::string tmp(first, last);
+    char *ptr = nullptr;
+    if constexpr (std::is_integral_v<NumericType>)
+      value = static_cast<NumericType>(std::strtoll(tmp.c_str(), &ptr, 10));
+    else
+      value = static_cast<NumericType>(std::strtold(tmp.c_str(), &ptr));
+    return ptr == tmp.c_str() + tmp.size();
+#endif
+  }
+
+  // Splits a data line at the delimiter. Like std::getline, a trailing
+  // delimiter does not start an additional empty value.
+  bool parseRow(std::string_view line, RowType &row) const {
+    row.clear();
+    while (!line.empty()) {
+      auto pos = line.find(delimiter);
+      NumericType value;
+      if (!parseValue(line.substr(0, pos), value))
+        return false;
+      row.push_back(value);
+      if (pos == std::string_view::npos)
+        break;
+      line.remove_prefix(pos + 1);
+    }
+    return true;
+  }
+
+  void parseChunk(Chunk &chunk) const {
+    const char *pos = chunk.begin;
+    RowType row;
+    while (pos < chunk.end) {
+      auto newline = static_cast<const char *>(
+          std::memchr(pos, '\n', static_cast<std::size_t>(chunk.end - pos)));
+      const char *lineEnd = newline ? newline : chunk.end;
+      auto line = trim(std::string_view(pos, lineEnd - pos));
+      pos = lineEnd + 1;
+      const int lineIndex = chunk.numLines++;
+
+      // Skip empty lines and lines marked as comment
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      if (!parseRow(line, row)) {
+        chunk.errorLine = lineIndex;
+        chunk.conversionError = true;
+        return;
+      }
+
+      if (chunk.firstRowLine < 0) {
+        chunk.firstRowLine = lineIndex;
+        chunk.firstRowCols = static_cast<int>(row.size());
+      } else if (static_cast<int>(row.size()) != chunk.firstRowCols) {
+        chunk.errorLine = lineIndex;
+        return;
+      }
+      chunk.rows.push_back(row);
+    }
+  }
+
+  std::vector<Chunk> splitChunks(const char *data, std::size_t size) const {
+    std::vector<Chunk> chunks;
+    const char *end = data + size;
+    const char *pos = data;
+    while (pos < end) {
+      Chunk chunk;
+      chunk.begin = pos;
+      if (static_cast<std::size_t>(end - pos) <= chunkSize) {
+        chunk.end = end;
+      } else {
+        // Extend the chunk to the end of the line it cuts into
+        auto newline = static_cast<const char *>(
+            std::memchr(pos + chunkSize, '\n',
+                        static_cast<std::size_t>(end - pos - chunkSize)));
+        chunk.end = newline ? newline + 1 : end;
+      }
+      pos = chunk.end;
+      chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+  }
+
+  void warning(const std::string &message, int lineIndex) {
+    errorLine = lineIndex;
+    Logger::getInstance()
+        .addWarning(message + " in line " + std::to_string(lineIndex) +
+                    " in '" + filename + "'")
+        .print();
+  }
 
 public:
   CSVReader() {}
@@ -31,98 +181,92 @@ public:
 
   void setDelimiter(char passedDelimiter) { delimiter = passedDelimiter; }
 
+  // Zero-based line of the row that made the last readContent call fail, or
+  // -1 if it succeeded.
+  int getErrorLine() const { return errorLine; }
+
   std::optional<std::string> readHeader() {
-    std::ifstream file(filename);
-    std::string header;
-    if (file.is_open()) {
-      std::string line;
-      // Iterate over each line
-      while (std::getline(file, line)) {
-        // Remove trailing and leading whitespaces
-        line = std::regex_replace(line, wsRegex, "$1");
-
-        // Skip empty lines at the top of the file
-        if (line.empty())
-          continue;
-
-        // If the line is marked as comment and it is located before any data
-        // at the top of the file, add it to the header string. Otherwise return
-        // the header string, since we are now reading data.
-        if (line.rfind('#') == 0) {
-          header += '\n' + line;
-        } else {
-          file.close();
-          break;
-        }
-      }
-    } else {
+    utils::MappedFile file;
+    if (!file.open(filename)) {
       Logger::getInstance()
           .addWarning("Couldn't open file '" + filename + "'")
           .print();
       return {};
     }
+
+    std::string header;
+    std::string_view content(reinterpret_cast<const char *>(file.data()),
+                             file.size());
+    // Iterate over each line
+    while (!content.empty()) {
+      auto pos = content.find('\n');
+      auto line = normalize(content.substr(0, pos));
+      content.remove_prefix(pos == std::string_view::npos ? content.size()
+                                                          : pos + 1);
+
+      // Skip empty lines at the top of the file
+      if (line.empty())
+        continue;
+
+      // If the line is marked as comment and it is located before any data
+      // at the top of the file, add it to the header string. Otherwise return
+      // the header string, since we are now reading data.
+      if (line[0] == '#')
+        header += '\n' + line;
+      else
+        break;
+    }
     return {header};
   }
 
-  std::optional<std::vector<std::vector<NumericType>>> readContent() {
-    std::ifstream file(filename);
-    if (file.is_open()) {
-      auto data = std::vector<std::vector<NumericType>>();
-
-      std::string line;
-      int lineCount = 0;
-
-      // Iterate over each line
-      while (std::getline(file, line)) {
-        ++lineCount;
-
-        // Remove trailing and leading whitespaces
-        line = std::regex_replace(line, wsRegex, "$1");
-        // Skip this line if it is marked as a comment
-        if (line.rfind('#') == 0)
-          continue;
-
-        std::istringstream iss(line);
-        std::string tmp;
-        std::vector<NumericType> a;
-        int i = 0;
-        while (std::getline(iss, tmp, delimiter)) {
-          auto valueOpt = utils::safeConvert<NumericType>(tmp);
-          if (valueOpt)
-            a.push_back(valueOpt.value());
-          else {
-            Logger::getInstance()
-                .addWarning("Error while reading line " +
-                            std::to_string(lineCount - 1) + " in '" + filename +
-                            "'")
-                .print();
-            return {};
-          }
-          ++i;
-        }
+  std::optional<std::vector<RowType>> readContent() {
+    errorLine = -1;
+    utils::MappedFile file;
+    if (!file.open(filename)) {
+      Logger::getInstance()
+          .addWarning("Couldn't open file '" + filename + "'")
+          .print();
+      return {};
+    }
+
+    auto chunks = splitChunks(reinterpret_cast<const char *>(file.data()),
+                              file.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < static_cast<long>(chunks.size()); ++i)
+      parseChunk(chunks[i]);
 
-        // The first row of actual data determins the data dimension
+    // Merge the chunks in file order and report the first error. Line numbers
+    // in the messages are zero-based, as before.
+    std::size_t numRows = 0;
+    for (const auto &chunk : chunks)
+      numRows += chunk.rows.size();
+
+    std::vector<RowType> data;
+    data.reserve(numRows);
+    int lineOffset = 0;
+    for (auto &chunk : chunks) {
+      // The first row of actual data determines the data dimension
+      if (chunk.firstRowLine >= 0) {
         if (numCols == 0)
-          numCols = i;
-
-        if (i != numCols) {
-          Logger::getInstance()
-              .addWarning("Invalid number of columns in line " +
-                          std::to_string(lineCount - 1) + " in '" + filename +
-                          "'")
-              .print();
+          numCols = chunk.firstRowCols;
+        if (chunk.firstRowCols != numCols) {
+          warning("Invalid number of columns",
+                  lineOffset + chunk.firstRowLine);
           return {};
         }
-        data.push_back(a);
       }
-      file.close();
-      return data;
-    } else {
-      Logger::getInstance()
-          .addWarning("Couldn't open file '" + filename + "'")
-          .print();
-      return {};
+      if (chunk.errorLine >= 0) {
+        warning(chunk.conversionError ? "Error while reading value"
+                                      : "Invalid number of columns",
+                lineOffset + chunk.errorLine);
+        return {};
+      }
+      std::move(chunk.rows.begin(), chunk.rows.end(),
+                std::back_inserter(data));
+      lineOffset += chunk.numLines;
     }
+    return data;
   }
 };
 
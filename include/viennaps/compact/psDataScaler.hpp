@@ -3,8 +3,13 @@
 #include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include <vcLogger.hpp>
+
 namespace viennaps {
 
 using namespace viennacore;
@@ -77,7 +82,14 @@ public:
   }
 };
 
-// Class that calculates scaling factors based on median distances
+// Class that calculates scaling factors based on median distances. For large
+// data sets the median of the pairwise distances is estimated from a random
+// subsample of pairs, which keeps memory and time independent of the number of
+// data points. The number of sampled pairs follows from the
+// Dvoretzky-Kiefer-Wolfowitz inequality, such that the rank of the estimated
+// median deviates from the true median rank by more than rankError (as a
+// fraction of all pairs) with a probability of at most failureProbability. If
+// the data set has fewer pairs than that, the exact median is computed.
 template <typename NumericType>
 class MedianDistanceScaler : public DataScaler<NumericType> {
   using Parent = DataScaler<NumericType>;
@@ -89,9 +101,62 @@ class MedianDistanceScaler : public DataScaler<NumericType> {
 
   const ItemVectorType &data;
 
+  NumericType rankError = 0.01;
+  NumericType failureProbability = 1e-3;
+  unsigned seed = 0;
+
+  size_t numberOfSamples() const {
+    return static_cast<size_t>(
+        std::ceil(std::log(2. / failureProbability) /
+                  (2. * rankError * rankError)));
+  }
+
+  static NumericType median(std::vector<NumericType> &distances) {
+    size_t medianIndex = distances.size() / 2;
+    std::nth_element(distances.begin(), distances.begin() + medianIndex,
+                     distances.end());
+    return distances[medianIndex];
+  }
+
+  void setFactor(int i, NumericType medianDistance) {
+    if (medianDistance > 0)
+      scalingFactors[i] = 1.0 / medianDistance;
+    else
+      scalingFactors[i] = 1.0;
+  }
+
 public:
   MedianDistanceScaler(const ItemVectorType &passedData) : data(passedData) {}
 
+  MedianDistanceScaler(const ItemVectorType &passedData,
+                       NumericType passedRankError)
+      : data(passedData) {
+    setErrorBound(passedRankError, failureProbability);
+  }
+
+  // The rank error has to be positive and the failure probability within
+  // (0, 1). Otherwise the previous bound is kept.
+  void setErrorBound(NumericType passedRankError,
+                     NumericType passedFailureProbability = 1e-3) {
+    if (!(passedRankError > 0) || !(passedFailureProbability > 0) ||
+        !(passedFailureProbability < 1)) {
+      Logger::getInstance()
+          .addWarning("MedianDistanceScaler: invalid error bound (rank error " +
+                      std::to_string(passedRankError) +
+                      ", failure probability " +
+                      std::to_string(passedFailureProbability) +
+                      "). Keeping rank error " + std::to_string(rankError) +
+                      " and failure probability " +
+                      std::to_string(failureProbability) + ".")
+          .print();
+      return;
+    }
+    rankError = passedRankError;
+    failureProbability = passedFailureProbability;
+  }
+
+  void setSeed(unsigned passedSeed) { seed = passedSeed; }
+
   void apply() override {
     if (data.empty())
       return;
@@ -102,27 +167,47 @@ public:
     const auto &dat = data;
 
     int D = dat[0].size();
-    scalingFactors.resize(D, 0.);
+    scalingFactors.assign(D, 1.);
 
-    std::vector<NumericType> distances(triSize, 0.);
-    for (int i = 0; i < D; ++i) {
-      {
+    if (triSize == 0)
+      return;
+
+    if (triSize <= numberOfSamples()) {
+      // Exact median over all pairs
+      std::vector<NumericType> distances(triSize, 0.);
+      for (int i = 0; i < D; ++i) {
 #pragma omp parallel for default(none) firstprivate(i, size)                   \
     shared(dat, distances) schedule(dynamic)
-        for (int j = 1; j < size; ++j) {
-          for (int k = 0; k < j; ++k)
-            distances[j * (j - 1) / 2 + k] =
-                std::abs(dat.at(j)[i] - dat.at(k)[i]);
+        for (long j = 1; j < static_cast<long>(size); ++j) {
+          for (long k = 0; k < j; ++k)
+            distances[j * (j - 1) / 2 + k] = std::abs(dat[j][i] - dat[k][i]);
         }
+        setFactor(i, median(distances));
+      }
+      return;
+    }
+
+    // Draw the pairs once and use them for all dimensions
+    const size_t numSamples = numberOfSamples();
+    std::vector<std::pair<size_t, size_t>> pairs(numSamples);
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> first(0, size - 1);
+    std::uniform_int_distribution<size_t> second(0, size - 2);
+    for (auto &[j, k] : pairs) {
+      j = first(rng);
+      k = second(rng);
+      if (k >= j)
+        ++k;
+    }
 
-        size_t medianIndex = triSize / 2;
-        std::nth_element(distances.begin(), distances.begin() + medianIndex,
-                         distances.end());
-        if (distances[medianIndex] > 0)
-          scalingFactors[i] = 1.0 / distances[medianIndex];
-        else
-          scalingFactors[i] = 1.0;
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < D; ++i) {
+      std::vector<NumericType> distances(numSamples);
+      for (size_t s = 0; s < numSamples; ++s) {
+        const auto &[j, k] = pairs[s];
+        distances[s] = std::abs(dat[j][i] - dat[k][i]);
       }
+      setFactor(i, median(distances));
     }
   }
 };
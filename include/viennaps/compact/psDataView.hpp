@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace viennaps {
+
+// Non-owning, strided view of a two-dimensional data table. The view can
+// alias row-major as well as column-major storage. An optional owner keeps
+// the underlying storage (e.g. a memory-mapped file) alive.
+template <typename NumericType> class DataView {
+public:
+  using SizeType = std::size_t;
+  using ItemType = std::vector<NumericType>;
+  using VectorType = std::vector<ItemType>;
+
+private:
+  const NumericType *data_ = nullptr;
+  SizeType numRows_ = 0;
+  SizeType numCols_ = 0;
+  SizeType rowStride_ = 0;
+  SizeType colStride_ = 0;
+  std::shared_ptr<const void> owner_;
+
+public:
+  DataView() = default;
+
+  DataView(const NumericType *data, SizeType numRows, SizeType numCols,
+           SizeType rowStride, SizeType colStride,
+           std::shared_ptr<const void> owner = nullptr)
+      : data_(data), numRows_(numRows), numCols_(numCols),
+        rowStride_(rowStride), colStride_(colStride), owner_(std::move(owner)) {
+  }
+
+  static DataView rowMajor(const NumericType *data, SizeType numRows,
+                           SizeType numCols,
+                           std::shared_ptr<const void> owner = nullptr) {
+    return DataView(data, numRows, numCols, numCols, 1, std::move(owner));
+  }
+
+  static DataView columnMajor(const NumericType *data, SizeType numRows,
+                              SizeType numCols,
+                              std::shared_ptr<const void> owner = nullptr) {
+    return DataView(data, numRows, numCols, 1, numRows, std::move(owner));
+  }
+
+  NumericType operator()(SizeType row, SizeType col) const {
+    return data_[row * rowStride_ + col * colStride_];
+  }
+
+  SizeType rows() const { return numRows_; }
+  SizeType cols() const { return numCols_; }
+  bool empty() const { return numRows_ == 0 || numCols_ == 0; }
+
+  // Pointer to the first element of a column. The column is contiguous in
+  // memory if isColumnContiguous() returns true.
+  const NumericType *column(SizeType col) const {
+    return data_ + col * colStride_;
+  }
+  bool isColumnContiguous() const { return rowStride_ == 1; }
+
+  // Pointer to the first element of a row. The row is contiguous in memory if
+  // isRowContiguous() returns true.
+  const NumericType *row(SizeType row) const { return data_ + row * rowStride_; }
+  bool isRowContiguous() const { return colStride_ == 1; }
+
+  // Copies the viewed data into the row-wise layout used by DataSource.
+  VectorType toRows() const {
+    VectorType rows(numRows_, ItemType(numCols_));
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(numRows_); ++i)
+      for (SizeType j = 0; j < numCols_; ++j)
+        rows[i][j] = (*this)(i, j);
+    return rows;
+  }
+};
+
+} // namespace viennaps
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <algorithm>
-#include <set>
 #include <vector>
 
+#include "psDataView.hpp"
 #include "psValueEstimator.hpp"
 
 #include <vcLogger.hpp>
@@ -27,72 +27,141 @@ class RectilinearGridInterpolation : public ValueEstimator<NumericType, bool> {
   using Parent::inputDim;
   using Parent::outputDim;
 
-  std::vector<std::set<NumericType>> uniqueValues;
-  VectorType localData;
-
-  // For rectilinear grid interpolation to work, we first have to ensure that
-  // our input coordinates are arranged in a certain way
-  // Future improvement: parallelize the recursive sorting using OpenMP task
-  bool rearrange(typename VectorType::iterator start,
-                 typename VectorType::iterator end, int axis, bool capture) {
-    bool equalSize = true;
-
-    // We only reorder based on the input dimension, not the output dimension
-    if (axis >= inputDim)
-      return equalSize;
-
-    auto size = std::distance(start, end);
-    if (size > 1) {
-      // Now sort the data along the given axis
-      std::sort(start, end, [&](const auto &a, const auto &b) {
-        return a[axis] < b[axis];
-      });
-
-      // Record the indices that separate ranges of the same value
-      size_t rangeSize = 0;
-      std::vector<size_t> rangeBreaks;
-      rangeBreaks.push_back(0);
-      if (capture)
-        uniqueValues[axis].insert(start->at(axis));
-
-      for (unsigned i = 1; i < size; ++i)
-        if ((start + i - 1)->at(axis) != (start + i)->at(axis)) {
-          if (rangeSize == 0)
-            rangeSize = i;
-
-          size_t tmp = rangeBreaks.back();
-
-          rangeBreaks.push_back(i);
-          uniqueValues[axis].insert((start + i)->at(axis));
-
-          if (rangeSize != i - tmp) {
-            Logger::getInstance()
-                .addWarning("Data is not arranged in a rectilinear grid!")
-                .print();
-            equalSize = false;
-            return false;
-          }
-        }
+  // Data set via a view instead of a row-wise copy
+  DataView<NumericType> dataView;
+
+  // Sorted, unique grid coordinates along each input axis
+  std::vector<std::vector<NumericType>> axes;
+  // Number of grid points between two consecutive points along each axis. The
+  // last axis is the fastest varying one (row-major order).
+  std::vector<SizeType> strides;
+  // Output values of all grid points in row-major order, outputDim values per
+  // grid point
+  std::vector<NumericType> values;
+
+  // Sorts the coordinates of each axis and stores the values of all data
+  // points in a flat array in the order of the grid.
+  template <class Accessor>
+  bool buildGrid(const Accessor &get, SizeType numPoints) {
+    axes.assign(inputDim, {});
+
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < static_cast<long>(inputDim); ++i) {
+      auto &axis = axes[i];
+      axis.resize(numPoints);
+      for (SizeType n = 0; n < numPoints; ++n)
+        axis[n] = get(n, i);
+      std::sort(axis.begin(), axis.end());
+      axis.erase(std::unique(axis.begin(), axis.end()), axis.end());
+    }
 
-      rangeBreaks.push_back(size);
+    strides.assign(inputDim, 1);
+    SizeType numGridPoints = 1;
+    for (int i = inputDim - 1; i >= 0; --i) {
+      strides[i] = numGridPoints;
+      numGridPoints *= axes[i].size();
+    }
 
-      // Recursively launch sorting tasks for each of the separated ranges. Only
-      // the first leaf in each level of the tree is instructed to capture the
-      // unique values.
-      for (unsigned i = 1; i < rangeBreaks.size(); ++i)
-        equalSize = equalSize && rearrange(start + rangeBreaks[i - 1],
-                                           start + rangeBreaks[i], axis + 1,
-                                           capture && (i == 1));
+    // A rectilinear grid contains every combination of axis coordinates
+    // exactly once
+    if (numGridPoints != numPoints)
+      return false;
+
+    values.resize(numGridPoints * outputDim);
+    std::vector<char> filled(numGridPoints, 0);
+
+#pragma omp parallel for
+    for (long n = 0; n < static_cast<long>(numPoints); ++n) {
+      SizeType index = 0;
+      for (SizeType i = 0; i < inputDim; ++i) {
+        const auto &axis = axes[i];
+        auto it = std::lower_bound(axis.begin(), axis.end(), get(n, i));
+        index += std::distance(axis.begin(), it) * strides[i];
+      }
+      for (SizeType k = 0; k < outputDim; ++k)
+        values[index * outputDim + k] = get(n, inputDim + k);
+#pragma omp atomic write
+      filled[index] = 1;
     }
 
-    return equalSize;
+    return std::all_of(filled.begin(), filled.end(),
+                       [](char f) { return f != 0; });
+  }
+
+  // Multilinear interpolation of the grid values at the given input. The
+  // indices and weights buffers have to hold inputDim elements. Returns
+  // whether the input lies within the bounds of the grid.
+  bool interpolate(const NumericType *input, NumericType *output,
+                   SizeType *indices, NumericType *weights) const {
+    bool isInside = true;
+
+    // Find the grid cell containing the input by a binary search per axis
+    for (SizeType i = 0; i < inputDim; ++i) {
+      const auto &axis = axes[i];
+      if (input[i] < axis.front() || input[i] > axis.back())
+        isInside = false;
+
+      if (input[i] <= axis.front()) {
+        // The coordinate is lower than or equal to the lowest grid point
+        indices[i] = 0;
+        weights[i] = 0.;
+      } else if (input[i] >= axis.back()) {
+        // The coordinate is greater than or equal to the greatest grid point
+        indices[i] = axis.size() - 1;
+        weights[i] = 1.;
+      } else {
+        // First element that is greater than input[i]
+        auto upperIt = std::upper_bound(axis.begin(), axis.end(), input[i]);
+        indices[i] = std::distance(axis.begin(), upperIt) - 1;
+        NumericType upperBound = *upperIt;
+        NumericType lowerBound = *(upperIt - 1);
+        weights[i] = (input[i] - lowerBound) / (upperBound - lowerBound);
+      }
+    }
+
+    std::fill_n(output, outputDim, NumericType(0));
+
+    // Sum up the contributions of all corners of the cell. Each bit of the
+    // corner variable selects the lower (0) or upper (1) bound along an axis.
+    // If the input lies at or beyond the upper end of an axis, both bounds
+    // refer to the last grid point.
+    const SizeType numCorners = SizeType(1) << inputDim;
+    for (SizeType corner = 0; corner < numCorners; ++corner) {
+      NumericType weight = 1.;
+      SizeType index = 0;
+      for (SizeType i = 0; i < inputDim; ++i) {
+        const bool upper = (corner >> i) & 1;
+        weight *= upper ? weights[i] : 1 - weights[i];
+        SizeType axisIndex = indices[i];
+        if (upper && axisIndex + 1 < axes[i].size())
+          ++axisIndex;
+        index += axisIndex * strides[i];
+      }
+      if (weight == 0)
+        continue;
+      const NumericType *cornerValues = &values[index * outputDim];
+      for (SizeType k = 0; k < outputDim; ++k)
+        output[k] += weight * cornerValues[k];
+    }
+
+    return isInside;
   }
 
 public:
+  using Parent::setData;
+
   RectilinearGridInterpolation() {}
 
+  // Uses the view directly, without copying the data into rows first.
+  void setData(const DataView<NumericType> &view) override {
+    dataView = view;
+    data = nullptr;
+    dataChanged = true;
+  }
+
   bool initialize() override {
-    if (!data || (data && data->empty())) {
+    const bool useView = !data && !dataView.empty();
+    if (!useView && (!data || data->empty())) {
       Logger::getInstance()
           .addWarning(
               "RectilinearGridInterpolation: the provided data is empty.")
@@ -100,40 +169,44 @@ public:
       return false;
     }
 
-    if (data->at(0).size() != inputDim + outputDim) {
+    const SizeType numCols = useView ? dataView.cols() : data->at(0).size();
+    if (numCols != inputDim + outputDim) {
       Logger::getInstance()
           .addWarning(
-              "psNearestNeighborsInterpolation: the sum of the provided "
+              "RectilinearGridInterpolation: the sum of the provided "
               "InputDimension and OutputDimension does not match the "
               "dimension of the provided data.")
           .print();
       return false;
     }
 
-    localData.clear();
-    localData.reserve(data->size());
-    std::copy(data->begin(), data->end(), std::back_inserter(localData));
-
-    uniqueValues.resize(inputDim);
-
-    auto equalSize = rearrange(localData.begin(), localData.end(), 0, true);
+    bool isGrid;
+    if (useView) {
+      isGrid = buildGrid(
+          [this](SizeType n, SizeType i) { return dataView(n, i); },
+          dataView.rows());
+    } else {
+      const auto &rows = *data;
+      for (const auto &row : rows)
+        if (row.size() != numCols) {
+          Logger::getInstance()
+              .addWarning("RectilinearGridInterpolation: the rows of the "
+                          "provided data differ in size.")
+              .print();
+          return false;
+        }
+      isGrid = buildGrid(
+          [&rows](SizeType n, SizeType i) { return rows[n][i]; },
+          rows.size());
+    }
 
-    if (!equalSize) {
+    if (!isGrid) {
       Logger::getInstance()
           .addWarning("Data is not arranged in a rectilinear grid!")
           .print();
       return false;
     }
 
-    for (int i = 0; i < inputDim; ++i)
-      if (uniqueValues[i].empty()) {
-        Logger::getInstance()
-            .addWarning("The grid has no values along dimension " +
-                        std::to_string(i))
-            .print();
-        return false;
-      }
-
     dataChanged = false;
     return true;
   }
@@ -144,99 +217,39 @@ public:
       if (!initialize())
         return {};
 
-    bool isInside = true;
-    for (int i = 0; i < inputDim; ++i)
-      if (!uniqueValues[i].empty()) {
-        // Check if the input lies within the bounds of our data grid
-        if (input[i] < *(uniqueValues[i].begin()) ||
-            input[i] > *(uniqueValues[i].rbegin())) {
-          isInside = false;
-        }
-      } else {
-        return {};
-      }
-
-    std::vector<SizeType> gridIndices(inputDim, 0);
-    std::vector<NumericType> normalizedCoordinates(inputDim, 0.);
-
-    // Check in which hyperrectangle the provided input coordinates are located
-    for (int i = 0; i < inputDim; ++i) {
-      if (input[i] <= *uniqueValues[i].begin()) {
-        // The coordinate is lower than or equal to the lowest grid point along
-        // the axis i.
-        gridIndices[i] = 0;
-        normalizedCoordinates[i] = 0;
-      } else if (input[i] >= *uniqueValues[i].rbegin()) {
-        // The coordinate is greater than or equal to the greatest grid point
-        // along the axis i.
-        gridIndices[i] = uniqueValues[i].size() - 1;
-        normalizedCoordinates[i] = 1.;
-      } else {
-        // The coordinate is somewhere in between (excluding) the lowest and
-        // greatest grid point.
-
-        // The following function returns an iterator pointing to the first
-        // element that is greater than input[i].
-        auto upperIt = uniqueValues[i].upper_bound(input[i]);
+    if (input.size() < inputDim)
+      return {};
 
-        // Get the index of the lower bound (upper bound index - 1)
-        gridIndices[i] = std::distance(uniqueValues[i].begin(), upperIt) - 1;
+    std::vector<SizeType> indices(inputDim);
+    std::vector<NumericType> weights(inputDim);
+    ItemType result(outputDim);
+    bool isInside = interpolate(input.data(), result.data(), indices.data(),
+                                weights.data());
 
-        NumericType upperBound = *upperIt;
-        NumericType lowerBound = *(--upperIt);
-        normalizedCoordinates[i] =
-            (input[i] - lowerBound) / (upperBound - lowerBound);
-      }
-    }
+    return {{result, isInside}};
+  }
 
-    // Now retrieve the values at the corners of the selected hyperrectangle
-    std::vector<std::vector<NumericType>> cornerValues(
-        1 << inputDim, std::vector<NumericType>(outputDim, 0.));
-
-    for (int i = 0; i < cornerValues.size(); ++i) {
-      size_t index = 0;
-      size_t stepsize = 1;
-
-      for (int j = inputDim - 1; j >= 0; --j) {
-        // To get all combinations of corners of the hyperrectangle, we say
-        // that each bit in the i variable corresponds to an axis. A zero
-        // bit at a certain location represents a lower bound of the
-        // hyperrectangle along the axis and a one represents the upper
-        // bound.
-        int lower = (i >> j) & 1;
-
-        // If the grid index is at the maximum in this axis, always mark this
-        // point as the lower point (thus if the input lies at or outside of the
-        // upper edge boundary of the grid in the given axis, we use the same
-        // corner multiple times)
-        if (gridIndices[j] == uniqueValues[j].size() - 1)
-          lower = 1;
-
-        // If it is a lower bound, use the grid index itself, otherwise add
-        // 1 to the index (= index of upper bound along that axis)
-        index += (gridIndices[j] + (1 - lower)) * stepsize;
-        stepsize *= uniqueValues[j].size();
-      }
-      const auto &corner = localData.at(index);
-      std::copy(corner.cbegin() + inputDim, corner.cend(),
-                cornerValues[i].begin());
-    }
+  bool estimateBatch(const NumericType *inputs, SizeType numInputs,
+                     NumericType *outputs,
+                     std::tuple<bool> *feedback = nullptr) override {
+    if (dataChanged && !initialize())
+      return false;
 
-    // Now do the actual linear interpolation
-    std::vector<NumericType> result(outputDim, 0.);
-    for (int dim = 0; dim < outputDim; ++dim) {
-      for (int i = inputDim - 1; i >= 0; --i) {
-        int stride = 1 << i;
-        for (int j = 0; j < stride; ++j) {
-          cornerValues[j][dim] =
-              normalizedCoordinates[i] * cornerValues[j][dim] +
-              (1 - normalizedCoordinates[i]) * cornerValues[j + stride][dim];
-        }
+#pragma omp parallel
+    {
+      std::vector<SizeType> indices(inputDim);
+      std::vector<NumericType> weights(inputDim);
+
+#pragma omp for
+      for (long n = 0; n < static_cast<long>(numInputs); ++n) {
+        bool isInside = interpolate(inputs + n * inputDim,
+                                    outputs + n * outputDim, indices.data(),
+                                    weights.data());
+        if (feedback)
+          feedback[n] = {isInside};
       }
-      result[dim] = cornerValues[0][dim];
     }
-
-    return {{result, isInside}};
+    return true;
   }
 };
 
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <optional>
 #include <tuple>
 #include <vector>
 
+#include "psDataView.hpp"
+
+#include <vcSmartPointer.hpp>
+
 namespace viennaps {
 
 using namespace viennacore;
@@ -30,15 +36,68 @@ public:
     outputDim = passedOutputDim;
   }
 
+  SizeType getInputDimension() const { return inputDim; }
+
+  SizeType getOutputDimension() const { return outputDim; }
+
   void setData(ConstPtr passedData) {
     data = passedData;
     dataChanged = true;
   }
 
+  // Sets the data from a view, e.g. obtained from BinaryDataSource::getView().
+  // By default the data is copied into the row-wise layout; estimators that
+  // can work on the view directly override this function.
+  virtual void setData(const DataView<NumericType> &view) {
+    setData(ConstPtr::New(view.toRows()));
+  }
+
   virtual bool initialize() { return true; }
 
   virtual std::optional<std::tuple<ItemType, FeedbackType...>>
   estimate(const ItemType &input) = 0;
+
+  // Estimates the values for numInputs points in parallel. The inputs are read
+  // from a row-major numInputs x inputDim matrix and the results are written
+  // to a preallocated, row-major numInputs x outputDim matrix. If feedback is
+  // not null, the feedback of each estimate is written to feedback[i]. Points
+  // for which the estimate fails are set to NaN and false is returned.
+  virtual bool estimateBatch(const NumericType *inputs, SizeType numInputs,
+                             NumericType *outputs,
+                             std::tuple<FeedbackType...> *feedback = nullptr) {
+    // Initialize once up front, since estimate() would otherwise do it
+    // concurrently on the first call in each thread.
+    if (dataChanged && !initialize())
+      return false;
+
+    bool success = true;
+#pragma omp parallel
+    {
+      ItemType input(inputDim);
+
+#pragma omp for reduction(&& : success)
+      for (long i = 0; i < static_cast<long>(numInputs); ++i) {
+        std::copy_n(inputs + i * inputDim, inputDim, input.begin());
+        auto estimateOpt = estimate(input);
+        NumericType *output = outputs + i * outputDim;
+        if (estimateOpt && std::get<0>(*estimateOpt).size() == outputDim) {
+          const auto &value = std::get<0>(*estimateOpt);
+          std::copy(value.begin(), value.end(), output);
+          if (feedback)
+            feedback[i] = std::apply(
+                [](const auto &, const auto &...rest) {
+                  return std::tuple<FeedbackType...>(rest...);
+                },
+                *estimateOpt);
+        } else {
+          std::fill_n(output, outputDim,
+                      std::numeric_limits<NumericType>::quiet_NaN());
+          success = false;
+        }
+      }
+    }
+    return success;
+  }
 };
 
 } // namespace viennaps
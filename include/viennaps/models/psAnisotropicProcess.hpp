@@ -3,8 +3,11 @@
 #include "../psMaterials.hpp"
 #include "../psProcessModel.hpp"
 
+#include <vcLogger.hpp>
 #include <vcVectorUtil.hpp>
 
+#include <algorithm>
+
 namespace viennaps {
 
 using namespace viennacore;
@@ -47,7 +50,7 @@ public:
   NumericType getScalarVelocity(const Vec3D<NumericType> & /*coordinate*/,
                                 int material, const Vec3D<NumericType> &nv,
                                 unsigned long /*pointID*/) override {
-    for (auto epitaxyMaterial : materials) {
+    for (const auto &epitaxyMaterial : materials) {
       if (MaterialMap::isMaterial(material, epitaxyMaterial.first)) {
         if (std::abs(Norm(nv) - 1.) > 1e-4)
           return 0.;
@@ -60,24 +63,10 @@ public:
         } else {
           normalVector[2] = 0;
         }
-        Normalize(normalVector);
-
-        Vec3D<NumericType> N;
-        for (int i = 0; i < 3; i++) {
-          N[i] = std::fabs(DotProduct(directions[i], normalVector));
-        }
-        std::sort(N.begin(), N.end(), std::greater<NumericType>());
 
-        NumericType velocity;
-        if (DotProduct(N, Vec3D<NumericType>{-1., 1., 2.}) < 0) {
-          velocity = (r100 * (N[0] - N[1] - 2 * N[2]) + r110 * (N[1] - N[2]) +
-                      3 * r311 * N[2]) /
-                     N[0];
-        } else {
-          velocity = (r111 * ((N[1] - N[0]) * 0.5 + N[2]) +
-                      r110 * (N[1] - N[2]) + 1.5 * r311 * (N[0] - N[1])) /
-                     N[0];
-        }
+        const NumericType velocity = lookupTable_.empty()
+                                         ? calculateVelocity(normalVector)
+                                         : interpolateVelocity(normalVector);
 
         return velocity * epitaxyMaterial.second;
       }
@@ -87,9 +76,125 @@ public:
     return 0.;
   }
 
+  // Precompute the crystal orientation velocity on an octahedral map of the
+  // unit sphere. The table resolution is doubled until the maximum deviation
+  // from the analytic velocity, relative to the largest rate, is below the
+  // tolerance or the maximum resolution is reached.
+  void buildLookupTable(const NumericType tolerance,
+                        const unsigned maxResolution = 2048) {
+    const NumericType maxRate = std::max(
+        {std::abs(r100), std::abs(r110), std::abs(r111), std::abs(r311)});
+
+    NumericType error = 0.;
+    resolution_ = 16;
+    do {
+      resolution_ *= 2;
+      const unsigned numNodes = resolution_ + 1;
+      lookupTable_.resize(numNodes * numNodes);
+#pragma omp parallel for
+      for (int j = 0; j < static_cast<int>(numNodes); ++j) {
+        for (unsigned i = 0; i < numNodes; ++i) {
+          lookupTable_[j * numNodes + i] = calculateVelocity(
+              decodeOctahedral(NumericType(i) / resolution_,
+                               NumericType(j) / resolution_));
+        }
+      }
+
+      // largest deviation is expected in the cell centers
+      error = 0.;
+#pragma omp parallel for reduction(max : error)
+      for (int j = 0; j < static_cast<int>(resolution_); ++j) {
+        for (unsigned i = 0; i < resolution_; ++i) {
+          auto normal = decodeOctahedral((i + 0.5) / resolution_,
+                                         (j + 0.5) / resolution_);
+          error = std::max(error, std::abs(interpolateVelocity(normal) -
+                                           calculateVelocity(normal)));
+        }
+      }
+      if (maxRate > 0.)
+        error /= maxRate;
+    } while (error > tolerance && 2 * resolution_ <= maxResolution);
+
+    Logger::getInstance()
+        .addInfo("Anisotropic velocity lookup table: resolution " +
+                 std::to_string(resolution_) + ", relative error " +
+                 std::to_string(error))
+        .print();
+  }
+
+  void clearLookupTable() {
+    lookupTable_.clear();
+    resolution_ = 0;
+  }
+
   // the translation field should be disabled when using a surface model
   // which only depends on an analytic velocity field
   int getTranslationFieldOptions() const override { return 0; }
+
+private:
+  // Analytic velocity for a surface normal. The result does not depend on the
+  // length of the normal vector.
+  NumericType calculateVelocity(const Vec3D<NumericType> &normalVector) const {
+    Vec3D<NumericType> N;
+    for (int i = 0; i < 3; i++) {
+      N[i] = std::fabs(DotProduct(directions[i], normalVector));
+    }
+    std::sort(N.begin(), N.end(), std::greater<NumericType>());
+
+    NumericType velocity;
+    if (DotProduct(N, Vec3D<NumericType>{-1., 1., 2.}) < 0) {
+      velocity = (r100 * (N[0] - N[1] - 2 * N[2]) + r110 * (N[1] - N[2]) +
+                  3 * r311 * N[2]) /
+                 N[0];
+    } else {
+      velocity = (r111 * ((N[1] - N[0]) * 0.5 + N[2]) + r110 * (N[1] - N[2]) +
+                  1.5 * r311 * (N[0] - N[1])) /
+                 N[0];
+    }
+    return velocity;
+  }
+
+  // Bilinear interpolation in the octahedral lookup table.
+  NumericType
+  interpolateVelocity(const Vec3D<NumericType> &normalVector) const {
+    const NumericType l1 = std::abs(normalVector[0]) +
+                           std::abs(normalVector[1]) +
+                           std::abs(normalVector[2]);
+    NumericType u = normalVector[0] / l1;
+    NumericType v = normalVector[1] / l1;
+    if (normalVector[2] < 0.) {
+      const NumericType uFold = (1. - std::abs(v)) * (u < 0. ? -1. : 1.);
+      v = (1. - std::abs(u)) * (v < 0. ? -1. : 1.);
+      u = uFold;
+    }
+
+    const NumericType x = (u * 0.5 + 0.5) * resolution_;
+    const NumericType y = (v * 0.5 + 0.5) * resolution_;
+    const unsigned i = std::min(static_cast<unsigned>(x), resolution_ - 1);
+    const unsigned j = std::min(static_cast<unsigned>(y), resolution_ - 1);
+    const NumericType fx = x - i;
+    const NumericType fy = y - j;
+
+    const unsigned numNodes = resolution_ + 1;
+    const auto *row = &lookupTable_[j * numNodes + i];
+    return (1. - fy) * ((1. - fx) * row[0] + fx * row[1]) +
+           fy * ((1. - fx) * row[numNodes] + fx * row[numNodes + 1]);
+  }
+
+  // Unit normal for the octahedral map coordinates (u, v) in [0, 1]^2.
+  static Vec3D<NumericType> decodeOctahedral(NumericType u, NumericType v) {
+    u = 2. * u - 1.;
+    v = 2. * v - 1.;
+    Vec3D<NumericType> normal{u, v, NumericType(1) - std::abs(u) - std::abs(v)};
+    const NumericType t = std::max(-normal[2], NumericType(0.));
+    normal[0] += normal[0] >= 0. ? -t : t;
+    normal[1] += normal[1] >= 0. ? -t : t;
+    Normalize(normal);
+    return normal;
+  }
+
+  std::vector<NumericType> lookupTable_;
+  unsigned resolution_ = 0;
 };
 } // namespace impl
 
@@ -124,18 +229,28 @@ public:
     initialize();
   }
 
+  // Evaluate the crystal orientation velocity from a precomputed lookup table
+  // instead of the analytic expression. The tolerance specifies the maximum
+  // deviation from the analytic velocity relative to the largest rate.
+  void enableLookupTable(const NumericType tolerance = 1e-2) {
+    velocityField_->buildLookupTable(tolerance);
+  }
+
+  // Evaluate the analytic expression for every point (default).
+  void disableLookupTable() { velocityField_->clearLookupTable(); }
+
 private:
   void initialize() {
     // default surface model
     auto surfModel = SmartPointer<SurfaceModel<NumericType>>::New();
 
     // velocity field
-    auto velField =
+    velocityField_ =
         SmartPointer<impl::AnisotropicVelocityField<NumericType, D>>::New(
             direction100, direction010, r100, r110, r111, r311, materials);
 
     this->setSurfaceModel(surfModel);
-    this->setVelocityField(velField);
+    this->setVelocityField(velocityField_);
     this->setProcessName("AnisotropicProcess");
   }
 
@@ -150,6 +265,8 @@ private:
   NumericType r311 = 0.0300166666667;
 
   std::vector<std::pair<Material, NumericType>> materials;
+
+  SmartPointer<impl::AnisotropicVelocityField<NumericType, D>> velocityField_;
 };
 
 } // namespace viennaps
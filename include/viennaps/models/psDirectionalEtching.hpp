@@ -1,7 +1,13 @@
 #pragma once
 
+#include "../psGeometricModel.hpp"
 #include "../psMaterials.hpp"
 #include "../psProcessModel.hpp"
+#include "../psTranslationField.hpp"
+
+#include <hrleSparseIterator.hpp>
+#include <lsAdvect.hpp>
+#include <lsBooleanOperation.hpp>
 
 #include <vcVectorUtil.hpp>
 
@@ -57,6 +63,169 @@ private:
     return false;
   }
 };
+
+// Geometric sweep for pure directional etching along a grid axis. Every point
+// of the top level set which lies within the etch depth behind an exposed,
+// non-mask surface is removed. The sweep is computed directly on the sparse
+// grid by combining integer shifted copies of the level set, which requires a
+// logarithmic number of boolean operations in the etch depth. Mask materials
+// shadow the material below them. The sub-grid remainder of the etch depth is
+// advected with the velocity field. Directions which are not aligned with a
+// grid axis with an infinite boundary fall back to the level set advection.
+template <class NumericType, int D>
+class DirectionalSweepModel : public GeometricModel<NumericType, D> {
+  using LSPtr = SmartPointer<viennals::Domain<NumericType, D>>;
+  using GeometricModel<NumericType, D>::domain;
+  using GeometricModel<NumericType, D>::processDuration;
+
+  const Vec3D<NumericType> direction_;
+  const NumericType directionalVelocity_;
+  const std::vector<int> maskMaterials_;
+  const SmartPointer<VelocityField<NumericType>> velocityField_;
+
+public:
+  DirectionalSweepModel(const Vec3D<NumericType> &direction,
+                        const NumericType directionalVelocity,
+                        const std::vector<int> &mask,
+                        SmartPointer<VelocityField<NumericType>> velocityField)
+      : direction_(direction), directionalVelocity_(directionalVelocity),
+        maskMaterials_(mask), velocityField_(velocityField) {}
+
+  void apply() override {
+    auto &levelSets = domain->getLevelSets();
+    if (processDuration <= 0. || levelSets.empty())
+      return;
+
+    const int axis = getSweepAxis();
+    if (axis < 0) {
+      Logger::getInstance()
+          .addInfo("Directional sweep not possible for this direction and "
+                   "domain. Using level set advection.")
+          .print();
+      advect(processDuration);
+      return;
+    }
+
+    const auto gridDelta = domain->getGrid().getGridDelta();
+    const NumericType displacement =
+        direction_[axis] * directionalVelocity_ * processDuration;
+    const auto numCells =
+        static_cast<hrleIndexType>(std::abs(displacement) / gridDelta);
+    const int sign = displacement > 0. ? 1 : -1;
+
+    if (numCells > 0) {
+      auto top = levelSets.back();
+      auto mask = this->makeMaterialLevelSet(maskMaterials_);
+
+      // material remains where all points up to the etch depth behind it are
+      // either material or lie in the shadow of the mask
+      auto front = LSPtr::New(top);
+      if (mask) {
+        auto shadow = sweep(mask, axis, numCells, -sign,
+                            viennals::BooleanOperationEnum::UNION);
+        viennals::BooleanOperation<NumericType, D>(
+            front, shadow, viennals::BooleanOperationEnum::UNION)
+            .apply();
+      }
+      front = sweep(front, axis, numCells, sign,
+                    viennals::BooleanOperationEnum::INTERSECT);
+
+      viennals::BooleanOperation<NumericType, D>(
+          top, front, viennals::BooleanOperationEnum::INTERSECT)
+          .apply();
+      if (mask) {
+        viennals::BooleanOperation<NumericType, D>(
+            top, mask, viennals::BooleanOperationEnum::UNION)
+            .apply();
+      }
+      for (std::size_t i = 0; i + 1 < levelSets.size(); ++i) {
+        viennals::BooleanOperation<NumericType, D>(
+            levelSets[i], top, viennals::BooleanOperationEnum::INTERSECT)
+            .apply();
+      }
+    }
+
+    // remaining sub-grid etch depth
+    const NumericType remainingTime =
+        processDuration *
+        (1. - numCells * gridDelta / std::abs(displacement));
+    if (remainingTime > 0.)
+      advect(remainingTime);
+  }
+
+private:
+  // Returns the grid axis of the etch direction, or -1 if the direction is
+  // not aligned with a grid axis or the boundary along it is not infinite.
+  int getSweepAxis() const {
+    int axis = -1;
+    for (int i = 0; i < D; ++i) {
+      if (direction_[i] == 0.)
+        continue;
+      if (axis >= 0)
+        return -1;
+      axis = i;
+    }
+    if (axis < 0 || directionalVelocity_ == 0.)
+      return -1;
+
+    using BoundaryType = viennals::BoundaryConditionEnum<D>;
+    const auto boundary = domain->getGrid().getBoundaryConditions(axis);
+    if (boundary == BoundaryType::REFLECTIVE_BOUNDARY ||
+        boundary == BoundaryType::PERIODIC_BOUNDARY)
+      return -1;
+
+    return axis;
+  }
+
+  // Combines the level set with its copies shifted by 1 to numCells grid
+  // points along the axis. The shift is doubled in each step.
+  LSPtr sweep(LSPtr levelSet, const int axis, const hrleIndexType numCells,
+              const int sign, viennals::BooleanOperationEnum operation) const {
+    auto result = LSPtr::New(levelSet);
+    hrleIndexType covered = 0;
+    while (covered < numCells) {
+      // result covers the shifts [0, covered]
+      const auto step = std::min(covered + 1, numCells - covered);
+      auto shifted = shift(result, axis, sign * step);
+      viennals::BooleanOperation<NumericType, D>(result, shifted, operation)
+          .apply();
+      covered += step;
+    }
+    return result;
+  }
+
+  // Exact copy of the level set shifted by an integer number of grid points.
+  LSPtr shift(LSPtr levelSet, const int axis,
+              const hrleIndexType offset) const {
+    typename viennals::Domain<NumericType, D>::PointValueVectorType points;
+    points.reserve(levelSet->getNumberOfPoints());
+    for (hrleConstSparseIterator<
+             typename viennals::Domain<NumericType, D>::DomainType>
+             it(levelSet->getDomain());
+         !it.isFinished(); ++it) {
+      if (!it.isDefined())
+        continue;
+      auto index = it.getStartIndices();
+      index[axis] += offset;
+      points.push_back(std::make_pair(index, it.getValue()));
+    }
+
+    auto shifted = LSPtr::New(levelSet->getGrid());
+    shifted->insertPoints(points);
+    return shifted;
+  }
+
+  void advect(const NumericType time) {
+    auto transField = SmartPointer<TranslationField<NumericType>>::New(
+        velocityField_, domain->getMaterialMap());
+    viennals::Advect<NumericType, D> advectionKernel;
+    advectionKernel.setVelocityField(transField);
+    for (auto ls : domain->getLevelSets())
+      advectionKernel.insertNextLevelSet(ls);
+    advectionKernel.setAdvectionTime(time);
+    advectionKernel.apply();
+  }
+};
 } // namespace impl
 
 /// Directional etching with one masking material.
@@ -80,6 +249,8 @@ public:
     this->setSurfaceModel(surfModel);
     this->setVelocityField(velField);
     this->setProcessName("DirectionalEtching");
+    initSweepModel(direction, directionalVelocity, isotropicVelocity,
+                   maskMaterialsInt);
   }
 
   DirectionalEtching(const Vec3D<NumericType> &direction,
@@ -102,7 +273,42 @@ public:
     this->setSurfaceModel(surfModel);
     this->setVelocityField(velField);
     this->setProcessName("DirectionalEtching");
+    initSweepModel(direction, directionalVelocity, isotropicVelocity,
+                   maskMaterialsInt);
+  }
+
+  // Compute the etched surface in a single geometric sweep instead of
+  // advecting the surface in time steps. This is only possible for purely
+  // directional etching (zero isotropic velocity).
+  void enableGeometricSweep() {
+    if (!sweepModel_) {
+      Logger::getInstance()
+          .addWarning("Geometric sweep is only possible for purely "
+                      "directional etching.")
+          .print();
+      return;
+    }
+    this->setGeometricModel(sweepModel_);
   }
+
+  // Advect the surface with the level set time integration (default).
+  void disableGeometricSweep() { this->setGeometricModel(nullptr); }
+
+private:
+  void initSweepModel(const Vec3D<NumericType> &direction,
+                      const NumericType directionalVelocity,
+                      const NumericType isotropicVelocity,
+                      const std::vector<int> &maskMaterials) {
+    if (isotropicVelocity != 0.)
+      return;
+    sweepModel_ =
+        SmartPointer<impl::DirectionalSweepModel<NumericType, D>>::New(
+            direction, directionalVelocity, maskMaterials,
+            this->getVelocityField());
+  }
+
+  SmartPointer<impl::DirectionalSweepModel<NumericType, D>> sweepModel_ =
+      nullptr;
 };
 
 } // namespace viennaps
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "../psGeometricModel.hpp"
 #include "../psMaterials.hpp"
 #include "../psProcessModel.hpp"
 #include "../psSurfaceModel.hpp"
 #include "../psVelocityField.hpp"
 
+#include <lsBooleanOperation.hpp>
+#include <lsGeometricAdvect.hpp>
+#include <lsGeometricAdvectDistributions.hpp>
+
 #include <vcSmartPointer.hpp>
 
 namespace viennaps {
@@ -46,6 +51,60 @@ private:
     return false;
   }
 };
+
+// Computes the final surface of a constant rate isotropic process in a single
+// geometric offset of the top level set by rate * process duration. Surfaces
+// of mask materials do not move and mask layers are held fixed.
+template <class NumericType, int D>
+class IsotropicOffsetModel : public GeometricModel<NumericType, D> {
+  using LSPtr = SmartPointer<viennals::Domain<NumericType, D>>;
+  using GeometricModel<NumericType, D>::domain;
+  using GeometricModel<NumericType, D>::processDuration;
+
+  const NumericType rate_ = 1.;
+  const std::vector<int> maskMaterials_;
+
+public:
+  IsotropicOffsetModel(NumericType rate, const std::vector<int> &mask)
+      : rate_{rate}, maskMaterials_{mask} {}
+
+  void apply() override {
+    const NumericType distance = rate_ * processDuration;
+    auto &levelSets = domain->getLevelSets();
+    if (distance == 0. || levelSets.empty())
+      return;
+
+    const auto gridDelta = domain->getGrid().getGridDelta();
+    auto mask = this->makeMaterialLevelSet(maskMaterials_);
+
+    auto dist =
+        SmartPointer<viennals::SphereDistribution<hrleCoordType, D>>::New(
+            distance, gridDelta);
+    if (mask) {
+      viennals::GeometricAdvect<NumericType, D>(levelSets.back(), dist, mask)
+          .apply();
+    } else {
+      viennals::GeometricAdvect<NumericType, D>(levelSets.back(), dist)
+          .apply();
+    }
+
+    if (distance < 0.) {
+      // keep the mask layers and remove the etched volume from all lower
+      // level sets, same as in the level set advection
+      if (mask) {
+        viennals::BooleanOperation<NumericType, D>(
+            levelSets.back(), mask, viennals::BooleanOperationEnum::UNION)
+            .apply();
+      }
+      for (std::size_t i = 0; i + 1 < levelSets.size(); ++i) {
+        viennals::BooleanOperation<NumericType, D>(
+            levelSets[i], levelSets.back(),
+            viennals::BooleanOperationEnum::INTERSECT)
+            .apply();
+      }
+    }
+  }
+};
 } // namespace impl
 
 /// Isotropic etching with one masking material.
@@ -59,6 +118,9 @@ public:
 
     // velocity field
     std::vector<int> maskMaterialsInt = {static_cast<int>(maskMaterial)};
+    offsetModel_ =
+        SmartPointer<impl::IsotropicOffsetModel<NumericType, D>>::New(
+            isotropicRate, maskMaterialsInt);
     auto velField =
         SmartPointer<impl::IsotropicVelocityField<NumericType, D>>::New(
             isotropicRate, std::move(maskMaterialsInt));
@@ -78,6 +140,9 @@ public:
     for (const auto &mat : maskMaterials) {
       maskMaterialsInt.push_back(static_cast<int>(mat));
     }
+    offsetModel_ =
+        SmartPointer<impl::IsotropicOffsetModel<NumericType, D>>::New(
+            isotropicRate, maskMaterialsInt);
     auto velField =
         SmartPointer<impl::IsotropicVelocityField<NumericType, D>>::New(
             isotropicRate, std::move(maskMaterialsInt));
@@ -86,6 +151,16 @@ public:
     this->setVelocityField(velField);
     this->setProcessName("IsotropicProcess");
   }
+
+  // Skip the time stepping and compute the final surface in a single exact
+  // offset of rate * process duration.
+  void enableAnalyticOffset() { this->setGeometricModel(offsetModel_); }
+
+  // Advect the surface with the level set time integration (default).
+  void disableAnalyticOffset() { this->setGeometricModel(nullptr); }
+
+private:
+  SmartPointer<impl::IsotropicOffsetModel<NumericType, D>> offsetModel_;
 };
 
 } // namespace viennaps
@@ -101,65 +101,44 @@ public:
     assert(domain->getCellSet());
     auto &cellSet = domain->getCellSet();
 
-    // redeposition
-    auto mesh = SmartPointer<viennals::Mesh<T>>::New();
-    ToDiskMesh<T, D>(domain, mesh).apply();
+    // the surface is advected between the calls
+    updateSurface();
 
-    const auto &points = mesh->nodes;
-    auto materialIds = mesh->getCellData().getScalarData("MaterialIds");
-
-    // save points where the surface is etched before advection
-    nodes.clear();
-    nodes.reserve(points.size());
-    for (size_t i = 0; i < points.size(); i++) {
-      auto material = MaterialMap::mapToMaterial(materialIds->at(i));
-      if (material == Material::Si3N4)
-        nodes.push_back(points[i]);
-    }
-    nodes.shrink_to_fit();
+    const auto &points = mesh_->nodes;
 
     // redeposit oxide
     if (processTime - reDepoTimeInt * (counter + 1) > -1) {
+      updateCellMapping(cellSet);
+
       const auto numPoints = points.size();
       std::vector<T> depoRate(numPoints, 0.);
       auto ff = cellSet->getScalarData("byproductSum");
       auto cellMatIds = cellSet->getScalarData("Material");
 
-      for (size_t i = 0; i < numPoints; ++i) {
-        auto surfaceMaterial = MaterialMap::mapToMaterial(materialIds->at(i));
-        const auto &node = points[i];
-
-        // redeposit only on oxide
-        if ((surfaceMaterial == Material::SiO2 ||
-             surfaceMaterial == Material::Polymer) &&
-            node[D - 1] < top) {
-          auto cellIdx = cellSet->getIndex(node);
-          int n = 0;
-          if (cellIdx == -1)
-            continue;
+#pragma omp parallel for
+      for (int i = 0; i < static_cast<int>(numPoints); ++i) {
+        // only gas cells around the surface point contribute
+        int n = 0;
+        for (int k = cellOffsets_[i]; k < cellOffsets_[i + 1]; ++k) {
+          const auto cellIdx = surfaceCells_[k];
           if (MaterialMap::mapToMaterial(cellMatIds->at(cellIdx)) ==
               Material::GAS) {
-            depoRate[i] = ff->at(cellIdx);
+            depoRate[i] += ff->at(cellIdx);
             n++;
           }
-          for (const auto ni : cellSet->getNeighbors(cellIdx)) {
-            if (ni != -1 && MaterialMap::mapToMaterial(cellMatIds->at(ni)) ==
-                                Material::GAS) {
-              depoRate[i] += ff->at(ni);
-              n++;
-            }
-          }
+        }
+        if (cellOffsets_[i] == cellOffsets_[i + 1])
+          continue;
 
-          if (n > 1)
-            depoRate[i] /= static_cast<T>(n);
+        if (n > 1)
+          depoRate[i] /= static_cast<T>(n);
 
-          depoRate[i] /= processTime;
+        depoRate[i] /= processTime;
 
-          if (depoRate[i] < reDepositionThreshold)
-            depoRate[i] = 0.;
+        if (depoRate[i] < reDepositionThreshold)
+          depoRate[i] = 0.;
 
-          depoRate[i] *= reDepositionFactor;
-        }
+        depoRate[i] *= reDepositionFactor;
       }
 
       // advect surface
@@ -195,107 +174,354 @@ public:
     return true;
   }
 
+  // Solve the diffusion implicitly (backward Euler) with a conjugate gradient
+  // solver. Convection and sink are still treated explicitly, so the time
+  // step is only limited by the convection CFL condition instead of the much
+  // stricter diffusion stability limit.
+  void setImplicitDiffusion(const bool implicit) {
+    implicitDiffusion_ = implicit;
+  }
+
 private:
+  // Extract the surface disks and save the points where the surface is
+  // etched.
+  void updateSurface() {
+    mesh_ = SmartPointer<viennals::Mesh<T>>::New();
+    ToDiskMesh<T, D>(domain, mesh_).apply();
+
+    const auto &points = mesh_->nodes;
+    auto materialIds = mesh_->getCellData().getScalarData("MaterialIds");
+
+    // save points where the surface is etched before advection
+    nodes.clear();
+    nodes.reserve(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      auto material = MaterialMap::mapToMaterial(materialIds->at(i));
+      if (material == Material::Si3N4)
+        nodes.push_back(points[i]);
+    }
+    nodes.shrink_to_fit();
+  }
+
+  // Map each oxide surface point below the top to its cell and the
+  // neighboring cells, stored in compressed row format.
+  void updateCellMapping(SmartPointer<viennacs::DenseCellSet<T, D>> cellSet) {
+    const auto &points = mesh_->nodes;
+    auto materialIds = mesh_->getCellData().getScalarData("MaterialIds");
+    const auto numPoints = points.size();
+
+    cellOffsets_.assign(numPoints + 1, 0);
+    surfaceCells_.clear();
+    for (size_t i = 0; i < numPoints; ++i) {
+      auto surfaceMaterial = MaterialMap::mapToMaterial(materialIds->at(i));
+      const auto &node = points[i];
+
+      // redeposit only on oxide
+      if ((surfaceMaterial == Material::SiO2 ||
+           surfaceMaterial == Material::Polymer) &&
+          node[D - 1] < top) {
+        auto cellIdx = cellSet->getIndex(node);
+        if (cellIdx != -1) {
+          surfaceCells_.push_back(cellIdx);
+          for (const auto ni : cellSet->getNeighbors(cellIdx)) {
+            if (ni != -1)
+              surfaceCells_.push_back(ni);
+          }
+        }
+      }
+      cellOffsets_[i + 1] = static_cast<int>(surfaceCells_.size());
+    }
+  }
+
   void diffuseByproducts(SmartPointer<viennacs::DenseCellSet<T, D>> cellSet,
                          const T timeStep) {
     auto data = cellSet->getFillingFractions();
     auto materialIds = cellSet->getScalarData("Material");
-    auto elems = cellSet->getElements();
-    auto nodes = cellSet->getNodes();
     const auto gridDelta = cellSet->getGridDelta();
     // calculate time discretization
-    const T dt = std::min(gridDelta * gridDelta / diffusionCoefficient *
-                              timeStabilityFactor,
-                          T(1.));
-    const int numSteps = static_cast<int>(timeStep / dt);
+    const T dtExplicit = std::min(gridDelta * gridDelta / diffusionCoefficient *
+                                      timeStabilityFactor,
+                                  T(1.));
+    int numSteps = static_cast<int>(timeStep / dtExplicit);
+    T dt = dtExplicit;
+    if (implicitDiffusion_) {
+      // upwind convection is stable for a Courant number below one
+      const T maxStreamVel =
+          std::max(std::abs(holeStreamVel), std::abs(scallopStreamVel));
+      T dtMax = timeStep;
+      if (maxStreamVel > 0.)
+        dtMax = std::min(dtMax, convectionCFL_ * gridDelta / maxStreamVel);
+      numSteps = static_cast<int>(std::ceil(timeStep / dtMax));
+      dt = numSteps > 0 ? timeStep / numSteps : dtMax;
+    }
+    if (numSteps > 0)
+      solveByproducts(cellSet, dt, dtExplicit, numSteps);
+
+    auto sum = cellSet->getScalarData("byproductSum");
+
+#pragma omp parallel for shared(sum)
+    for (int e = 0; e < data->size(); e++) {
+      if (!MaterialMap::isMaterial(materialIds->at(e), Material::GAS)) {
+        continue;
+      }
+
+      assert(data->at(e) >= 0. && "Negative concentration");
+      sum->at(e) += data->at(e) * timeStep;
+    }
+  }
+
+  void solveByproducts(SmartPointer<viennacs::DenseCellSet<T, D>> cellSet,
+                       const T dt, const T dtExplicit, const int numSteps) {
+    auto data = cellSet->getFillingFractions();
+    const auto gridDelta = cellSet->getGridDelta();
+
+    buildStencil(cellSet);
+    const auto numGasCells = static_cast<int>(gasCells_.size());
+
     const T C = dt * diffusionCoefficient / (gridDelta * gridDelta);
-    const T holeC = dt / gridDelta * holeStreamVel;
-    const T scallopC = dt / gridDelta * scallopStreamVel;
+    // the sink removes a fixed amount per explicit time step
+    const T sinkStep = sink * dt / dtExplicit;
+
+    current_.resize(numGasCells);
+    next_.resize(numGasCells);
+#pragma omp parallel for
+    for (int g = 0; g < numGasCells; ++g)
+      current_[g] = data->at(gasCells_[g]);
 
     for (int ts = 0; ts < numSteps; ts++) {
-      std::vector<T> solution(data->size(), 0.);
+      if (implicitDiffusion_) {
+        // right hand side: previous state with explicit convection
+#pragma omp parallel for
+        for (int g = 0; g < numGasCells; ++g)
+          rhs_[g] = current_[g] + (sinkCells_[g] ? T(0.) : convection(g, dt));
+
+        solveImplicitDiffusion(C);
 
 #pragma omp parallel for
-      for (int e = 0; e < data->size(); e++) {
-        if (!MaterialMap::isMaterial(materialIds->at(e), Material::GAS)) {
-          continue;
+        for (int g = 0; g < numGasCells; ++g) {
+          if (sinkCells_[g])
+            next_[g] = std::max(next_[g] - sinkStep, T(0.));
         }
-
-        int numNeighbors = 0;
-        auto coord = nodes[elems[e][0]];
-        for (int i = 0; i < D; i++) {
-          coord[i] += gridDelta / 2.;
+      } else {
+#pragma omp parallel for
+        for (int g = 0; g < numGasCells; ++g) {
+          T neighborSum = 0.;
+          for (int k = neighborOffsets_[g]; k < neighborOffsets_[g + 1]; ++k)
+            neighborSum += current_[neighbors_[k]];
+          const T numNeighbors =
+              static_cast<T>(neighborOffsets_[g + 1] - neighborOffsets_[g]);
+
+          // diffusion
+          T value =
+              current_[g] + C * (neighborSum - numNeighbors * current_[g]);
+
+          if (sinkCells_[g]) {
+            // sink at the top
+            value = std::max(value - sinkStep, T(0.));
+          } else {
+            value += convection(g, dt);
+          }
+          next_[g] = value;
         }
+      }
+      std::swap(current_, next_);
+    }
 
-        auto cellNeighbors = cellSet->getNeighbors(e);
-        for (const auto &n : cellNeighbors) {
-          if (n == -1 ||
-              !MaterialMap::isMaterial(materialIds->at(n), Material::GAS))
-            continue;
+    // byproducts only exist in gas cells
+    std::fill(data->begin(), data->end(), T(0.));
+#pragma omp parallel for
+    for (int g = 0; g < numGasCells; ++g)
+      data->at(gasCells_[g]) = current_[g];
+  }
 
-          solution[e] += data->at(n);
-          numNeighbors++;
-        }
+  // Explicit upwind convection of a gas cell over the time step dt.
+  T convection(const int g, const T dt) const {
+    const int upwind = upwindCells_[g];
+    if (upwind == -1)
+      return 0.;
+    return dt * (upwindRates_[g] * current_[upwind] +
+                 selfRates_[g] * current_[g]);
+  }
 
-        // diffusion
-        solution[e] =
-            data->at(e) +
-            C * (solution[e] - static_cast<T>(numNeighbors) * data->at(e));
+  // Compact stencil of the gas cells, rebuilt once per call since the gas
+  // region changes with the advected surface.
+  void buildStencil(SmartPointer<viennacs::DenseCellSet<T, D>> cellSet) {
+    auto materialIds = cellSet->getScalarData("Material");
+    auto elems = cellSet->getElements();
+    auto nodes = cellSet->getNodes();
+    const auto gridDelta = cellSet->getGridDelta();
+    const auto numCells = static_cast<int>(materialIds->size());
+
+    gasIndex_.assign(numCells, -1);
+    gasCells_.clear();
+    for (int e = 0; e < numCells; ++e) {
+      if (MaterialMap::isMaterial(materialIds->at(e), Material::GAS)) {
+        gasIndex_[e] = static_cast<int>(gasCells_.size());
+        gasCells_.push_back(e);
+      }
+    }
 
-        // sink at the top
-        if (coord[D - 1] > top - gridDelta) {
-          solution[e] = std::max(solution[e] - sink, T(0.));
-          continue;
-        }
+    const auto numGasCells = gasCells_.size();
+    neighborOffsets_.assign(numGasCells + 1, 0);
+    neighbors_.clear();
+    neighbors_.reserve(numGasCells * 2 * D);
+    sinkCells_.assign(numGasCells, 0);
+    upwindCells_.assign(numGasCells, -1);
+    upwindRates_.assign(numGasCells, 0.);
+    selfRates_.assign(numGasCells, 0.);
+    rhs_.resize(numGasCells);
+
+    for (std::size_t g = 0; g < numGasCells; ++g) {
+      const int e = gasCells_[g];
+      auto coord = nodes[elems[e][0]];
+      for (int i = 0; i < D; i++) {
+        coord[i] += gridDelta / 2.;
+      }
 
-        // convection
-        if (std::abs(coord[0]) < holeRadius) {
-          // in hole
-          assert((cellNeighbors[2] != -1 && D == 2) ||
-                 (cellNeighbors[4] != -1 && D == 3) &&
-                     "holeStream up neighbor wrong");
-          if (MaterialMap::isMaterial(
-                  materialIds->at(cellNeighbors[2 * (D - 1)]), Material::GAS)) {
-            solution[e] -= holeC * (((coord[D - 1] - gridDelta) / top) *
-                                        data->at(cellNeighbors[2 * (D - 1)]) -
-                                    (coord[D - 1] / top) * data->at(e));
-          }
-        } else {
-          if (coord[0] < 0) {
-            // left side scallop - use forward difference
-            assert(cellNeighbors[1] != -1 &&
-                   "scallopStream right neighbor wrong");
-            if (MaterialMap::isMaterial(materialIds->at(cellNeighbors[1]),
-                                        Material::GAS)) {
-              solution[e] -=
-                  scallopC * (data->at(cellNeighbors[1]) - data->at(e));
-            }
-          } else {
-            // right side scallop - use backward difference
-            assert(cellNeighbors[0] != -1 &&
-                   "scallopStream left neighbor wrong");
-            if (MaterialMap::isMaterial(materialIds->at(cellNeighbors[0]),
-                                        Material::GAS)) {
-              solution[e] +=
-                  scallopC * (data->at(e) - data->at(cellNeighbors[0]));
-            }
-          }
+      const auto &cellNeighbors = cellSet->getNeighbors(e);
+      for (const auto &n : cellNeighbors) {
+        if (n != -1 && gasIndex_[n] != -1)
+          neighbors_.push_back(gasIndex_[n]);
+      }
+      neighborOffsets_[g + 1] = static_cast<int>(neighbors_.size());
+
+      // sink at the top
+      if (coord[D - 1] > top - gridDelta) {
+        sinkCells_[g] = 1;
+        continue;
+      }
+
+      // convection
+      if (std::abs(coord[0]) < holeRadius) {
+        // in hole
+        assert((cellNeighbors[2] != -1 && D == 2) ||
+               (cellNeighbors[4] != -1 && D == 3) &&
+                   "holeStream up neighbor wrong");
+        const int up = cellNeighbors[2 * (D - 1)];
+        const int n = up == -1 ? -1 : gasIndex_[up];
+        if (n != -1) {
+          const T holeRate = holeStreamVel / gridDelta;
+          upwindCells_[g] = n;
+          upwindRates_[g] = -holeRate * (coord[D - 1] - gridDelta) / top;
+          selfRates_[g] = holeRate * coord[D - 1] / top;
+        }
+      } else {
+        // left side scallop uses forward, right side backward difference
+        assert(cellNeighbors[coord[0] < 0 ? 1 : 0] != -1 &&
+               "scallopStream neighbor wrong");
+        const int side = cellNeighbors[coord[0] < 0 ? 1 : 0];
+        const int n = side == -1 ? -1 : gasIndex_[side];
+        if (n != -1) {
+          const T scallopRate = scallopStreamVel / gridDelta;
+          upwindCells_[g] = n;
+          upwindRates_[g] = -scallopRate;
+          selfRates_[g] = scallopRate;
         }
       }
-      *data = std::move(solution);
     }
-    auto sum = cellSet->getScalarData("byproductSum");
+  }
 
-#pragma omp parallel for shared(sum)
-    for (int e = 0; e < data->size(); e++) {
-      if (!MaterialMap::isMaterial(materialIds->at(e), Material::GAS)) {
-        continue;
+  // Solves (I + C * L) next = rhs with the graph Laplacian L of the gas cells
+  // using a Jacobi preconditioned conjugate gradient method.
+  void solveImplicitDiffusion(const T C) {
+    const auto numGasCells = static_cast<int>(gasCells_.size());
+    residual_.resize(numGasCells);
+    precond_.resize(numGasCells);
+    direction_.resize(numGasCells);
+    product_.resize(numGasCells);
+
+    auto applyMatrix = [&](const std::vector<T> &x, std::vector<T> &y) {
+#pragma omp parallel for
+      for (int g = 0; g < numGasCells; ++g) {
+        T neighborSum = 0.;
+        for (int k = neighborOffsets_[g]; k < neighborOffsets_[g + 1]; ++k)
+          neighborSum += x[neighbors_[k]];
+        const T numNeighbors =
+            static_cast<T>(neighborOffsets_[g + 1] - neighborOffsets_[g]);
+        y[g] = (1. + C * numNeighbors) * x[g] - C * neighborSum;
       }
+    };
+
+    // initial guess: previous state
+    next_ = current_;
+    applyMatrix(next_, product_);
+
+    T rz = 0., rhsNorm = 0.;
+#pragma omp parallel for reduction(+ : rz, rhsNorm)
+    for (int g = 0; g < numGasCells; ++g) {
+      residual_[g] = rhs_[g] - product_[g];
+      const T diagonal = 1. + C * static_cast<T>(neighborOffsets_[g + 1] -
+                                                 neighborOffsets_[g]);
+      precond_[g] = residual_[g] / diagonal;
+      direction_[g] = precond_[g];
+      rz += residual_[g] * precond_[g];
+      rhsNorm += rhs_[g] * rhs_[g];
+    }
 
-      assert(data->at(e) >= 0. && "Negative concentration");
-      sum->at(e) += data->at(e) * timeStep;
+    const T tolerance = cgTolerance_ * cgTolerance_ * rhsNorm;
+    for (unsigned it = 0; it < cgMaxIterations_; ++it) {
+      T residualNorm = 0.;
+#pragma omp parallel for reduction(+ : residualNorm)
+      for (int g = 0; g < numGasCells; ++g)
+        residualNorm += residual_[g] * residual_[g];
+      if (residualNorm <= tolerance)
+        break;
+
+      applyMatrix(direction_, product_);
+      T pAp = 0.;
+#pragma omp parallel for reduction(+ : pAp)
+      for (int g = 0; g < numGasCells; ++g)
+        pAp += direction_[g] * product_[g];
+      const T alpha = rz / pAp;
+
+      T rzNew = 0.;
+#pragma omp parallel for reduction(+ : rzNew)
+      for (int g = 0; g < numGasCells; ++g) {
+        next_[g] += alpha * direction_[g];
+        residual_[g] -= alpha * product_[g];
+        const T diagonal = 1. + C * static_cast<T>(neighborOffsets_[g + 1] -
+                                                   neighborOffsets_[g]);
+        precond_[g] = residual_[g] / diagonal;
+        rzNew += residual_[g] * precond_[g];
+      }
+
+      const T beta = rzNew / rz;
+      rz = rzNew;
+#pragma omp parallel for
+      for (int g = 0; g < numGasCells; ++g)
+        direction_[g] = precond_[g] + beta * direction_[g];
     }
   }
+
+  // surface points and their gas cells, the cells of point i are in
+  // [cellOffsets_[i], cellOffsets_[i + 1])
+  SmartPointer<viennals::Mesh<T>> mesh_;
+  std::vector<int> cellOffsets_;
+  std::vector<int> surfaceCells_;
+
+  bool implicitDiffusion_ = false;
+  T convectionCFL_ = 0.5;
+  T cgTolerance_ = 1e-8;
+  unsigned cgMaxIterations_ = 1000;
+
+  // gas cell stencil
+  std::vector<int> gasIndex_;
+  std::vector<int> gasCells_;
+  std::vector<int> neighborOffsets_;
+  std::vector<int> neighbors_;
+  std::vector<char> sinkCells_;
+  std::vector<int> upwindCells_;
+  std::vector<T> upwindRates_;
+  std::vector<T> selfRates_;
+
+  // solution buffers, allocated once
+  std::vector<T> current_;
+  std::vector<T> next_;
+  std::vector<T> rhs_;
+  std::vector<T> residual_;
+  std::vector<T> precond_;
+  std::vector<T> direction_;
+  std::vector<T> product_;
 };
 } // namespace impl
 
@@ -331,7 +557,19 @@ public:
     this->setSurfaceModel(surfModel);
     this->setAdvectionCallback(dynamics);
     this->setProcessName("OxideRegrowth");
+    dynamics_ = dynamics;
   }
+
+  // Solve the byproduct diffusion implicitly. This allows time steps limited
+  // only by the convection velocities instead of the diffusion stability
+  // limit, which is controlled by the time stability factor.
+  void enableImplicitDiffusion() { dynamics_->setImplicitDiffusion(true); }
+
+  // Solve the byproduct diffusion with explicit time steps (default).
+  void disableImplicitDiffusion() { dynamics_->setImplicitDiffusion(false); }
+
+private:
+  SmartPointer<impl::ByproductDynamics<NumericType, D>> dynamics_;
 };
 
 } // namespace viennaps
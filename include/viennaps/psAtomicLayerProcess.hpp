@@ -14,6 +14,8 @@
 #include <raySource.hpp>
 #include <rayTrace.hpp>
 
+#include <vcKDTree.hpp>
+
 namespace viennaps {
 
 using namespace viennacore;
@@ -94,6 +96,31 @@ public:
 
   void setNumCycles(unsigned int numCycles) { numCycles_ = numCycles; }
 
+  // Enable cycle extrapolation. After a traced cycle, the resulting surface
+  // velocities are reused for the following cycles, and several cycles are
+  // merged into a single advection step, as long as the accumulated surface
+  // displacement since the last trace stays below the tolerance (given in
+  // units of the grid delta). Once the geometry has drifted further, a fresh
+  // coverage solve is performed.
+  void enableCycleExtrapolation(NumericType driftTolerance = 0.5) {
+    if (driftTolerance <= 0.) {
+      Logger::getInstance()
+          .addWarning("Cycle extrapolation tolerance must be positive. "
+                      "Cycle extrapolation is disabled.")
+          .print();
+      extrapolationTolerance_ = 0.;
+      return;
+    }
+    extrapolationTolerance_ = driftTolerance;
+  }
+
+  // Disable cycle extrapolation. Every cycle is traced (default).
+  void disableCycleExtrapolation() { extrapolationTolerance_ = 0.; }
+
+  // Number of cycles traced in the last run, the remaining cycles were
+  // extrapolated.
+  unsigned int getNumberOfTracedCycles() const { return numTracedCycles_; }
+
   // Specify the number of rays to be traced for each particle throughout the
   // process. The total count of rays is the product of this number and the
   // number of points in the process geometry.
@@ -193,15 +220,68 @@ public:
     if (useProcessParams)
       Logger::getInstance().addInfo("Using process parameters.").print();
 
+    // cycle extrapolation state
+    const bool useExtrapolation = extrapolationTolerance_ > 0.;
+    const NumericType maxDrift = extrapolationTolerance_ * gridDelta;
+    KDTree<NumericType, Vec3D<NumericType>> tracedPointsTree;
+    std::vector<NumericType> tracedVelocities;
+    NumericType maxTracedVelocity = 0.;
+    NumericType drift = 0.;
+    numTracedCycles_ = 0;
+
     size_t counter = 0;
-    int numCycles = 0;
-    while (numCycles++ < numCycles_) {
+    unsigned int numCycles = 0;
+    while (numCycles < numCycles_) {
+      meshConverter.apply();
+
+      if (useExtrapolation && numTracedCycles_ > 0) {
+        // number of cycles that can be merged before the tolerance is reached
+        unsigned int mergedCycles = numCycles_ - numCycles;
+        if (maxTracedVelocity > 0.) {
+          // No cycles can be merged if a single cycle already exceeds the
+          // tolerance
+          const NumericType mergeable = std::max<NumericType>(
+              0., std::floor((maxDrift - drift) / maxTracedVelocity));
+          if (mergeable < mergedCycles)
+            mergedCycles = static_cast<unsigned int>(mergeable);
+        }
+
+        if (mergedCycles > 0) {
+          Logger::getInstance()
+              .addInfo("Cycles: " + std::to_string(numCycles + 1) + "-" +
+                       std::to_string(numCycles + mergedCycles) + "/" +
+                       std::to_string(numCycles_) + " (extrapolated)")
+              .print();
+
+          // map the traced velocities onto the current surface
+          auto const &points = diskMesh->getNodes();
+          auto velocities =
+              SmartPointer<std::vector<NumericType>>::New(points.size());
+#pragma omp parallel for
+          for (long i = 0; i < static_cast<long>(points.size()); ++i) {
+            auto nearest = tracedPointsTree.findNearest(points[i]);
+            velocities->at(i) = tracedVelocities[nearest->first];
+          }
+          pModel_->getVelocityField()->setVelocities(velocities);
+          if (pModel_->getVelocityField()->getTranslationFieldOptions() == 2)
+            transField->buildKdTree(points);
+
+          advectionKernel.setAdvectionTime(mergedCycles);
+          advectionKernel.apply();
+
+          drift += mergedCycles * maxTracedVelocity;
+          numCycles += mergedCycles;
+          continue;
+        }
+      }
+
+      ++numCycles;
+      ++numTracedCycles_;
       Logger::getInstance()
           .addInfo("Cycle: " + std::to_string(numCycles) + "/" +
                    std::to_string(numCycles_))
           .print();
 
-      meshConverter.apply();
       auto numPoints = diskMesh->nodes.size();
       surfaceModel->initializeCoverages(numPoints);
       auto rates = SmartPointer<viennals::PointData<NumericType>>::New();
@@ -217,10 +297,7 @@ public:
       int pulseCounter = 0;
 
       while (time < pulseTime_) {
-#ifdef VIENNAPS_PYTHON_BUILD
-        if (PyErr_CheckSignals() != 0)
-          throw pybind11::error_already_set();
-#endif
+        utils::checkPythonSignals();
 
         Logger::getInstance()
             .addInfo("Pulse time: " + std::to_string(time) + "/" +
@@ -359,6 +436,17 @@ public:
       if (pModel_->getVelocityField()->getTranslationFieldOptions() == 2)
         transField->buildKdTree(points);
 
+      // store the traced velocities for the extrapolated cycles
+      if (useExtrapolation) {
+        tracedVelocities = *velocities;
+        tracedPointsTree.setPoints(points);
+        tracedPointsTree.build();
+        maxTracedVelocity = 0.;
+        for (const auto v : tracedVelocities)
+          maxTracedVelocity = std::max(maxTracedVelocity, std::abs(v));
+        drift = maxTracedVelocity;
+      }
+
       // print debug output
       if (Logger::getLogLevel() >= 4) {
         diskMesh->getCellData().insertNextScalarData(*velocities, "velocities");
@@ -366,12 +454,19 @@ public:
         counter++;
       }
 
+      advectionKernel.setAdvectionTime(1.);
       advectionKernel.apply();
     }
 
     processTimer.finish();
 
     Logger::getInstance().addTiming("\nProcess " + name, processTimer).print();
+    if (useExtrapolation) {
+      Logger::getInstance()
+          .addInfo("Traced cycles: " + std::to_string(numTracedCycles_) + "/" +
+                   std::to_string(numCycles_))
+          .print();
+    }
   }
 
   void writeParticleDataLogs(std::string fileName) {
@@ -487,6 +582,8 @@ private:
   NumericType pulseTime_ = 0.;
   NumericType purgePulseTime_ = 0.;
   NumericType coverageTimeStep_ = 1.;
+  NumericType extrapolationTolerance_ = 0.;
+  unsigned int numTracedCycles_ = 0;
   std::vector<NumericType> desorptionRates_;
 };
 
@@ -4,10 +4,11 @@
 
 #include <lsBooleanOperation.hpp>
 #include <lsDomain.hpp>
-#include <lsFromSurfaceMesh.hpp>
 #include <lsGeometries.hpp>
 #include <lsMakeGeometry.hpp>
-#include <lsTransformMesh.hpp>
+
+#include <algorithm>
+#include <cmath>
 
 #include <vcLogger.hpp>
 #include <vcSmartPointer.hpp>
@@ -17,12 +18,142 @@ namespace viennaps {
 using namespace viennacore;
 
 template <class NumericType, int D = 3> class GDSGeometry {
-  using StructureLayers =
-      std::unordered_map<int16_t, SmartPointer<viennals::Mesh<NumericType>>>;
+  // polygon in grid units
+  using Polygon = std::vector<std::array<NumericType, 2>>;
+  using BoundingBox = std::array<std::array<NumericType, 2>, 2>;
   using lsDomainType = SmartPointer<viennals::Domain<NumericType, D>>;
   using BoundaryType = typename viennals::Domain<NumericType, D>::BoundaryType;
 
+  static constexpr NumericType far = std::numeric_limits<NumericType>::max();
+  // narrow band width in grid units
+  static constexpr NumericType width = 1.;
+  static constexpr unsigned maxReferenceDepth = 32;
+
+  // Affine placement of a structure in the coordinates of its parent.
+  struct Transform {
+    std::array<NumericType, 4> m = {1., 0., 0., 1.};
+    std::array<NumericType, 2> t = {0., 0.};
+
+    std::array<NumericType, 2> apply(NumericType x, NumericType y) const {
+      return {m[0] * x + m[1] * y + t[0], m[2] * x + m[3] * y + t[1]};
+    }
+
+    // this transform applied after other
+    Transform operator*(const Transform &other) const {
+      Transform result;
+      result.m = {m[0] * other.m[0] + m[1] * other.m[2],
+                  m[0] * other.m[1] + m[1] * other.m[3],
+                  m[2] * other.m[0] + m[3] * other.m[2],
+                  m[2] * other.m[1] + m[3] * other.m[3]};
+      result.t = apply(other.t[0], other.t[1]);
+      return result;
+    }
+
+    Transform inverse() const {
+      const NumericType det = m[0] * m[3] - m[1] * m[2];
+      Transform result;
+      result.m = {m[3] / det, -m[1] / det, -m[2] / det, m[0] / det};
+      result.t = {-(result.m[0] * t[0] + result.m[1] * t[1]),
+                  -(result.m[2] * t[0] + result.m[3] * t[1])};
+      return result;
+    }
+
+    bool isTranslation() const {
+      constexpr NumericType eps = 1e-9;
+      return std::abs(m[0] - 1.) < eps && std::abs(m[1]) < eps &&
+             std::abs(m[2]) < eps && std::abs(m[3] - 1.) < eps;
+    }
+  };
+
+  // 2D signed distance in grid units on a rectangular patch of grid points.
+  struct DistanceField {
+    hrleIndexType x0 = 0, y0 = 0;
+    std::size_t nx = 0, ny = 0;
+    std::vector<NumericType> values;
+
+    void resize(hrleIndexType minX, hrleIndexType minY, hrleIndexType maxX,
+                hrleIndexType maxY) {
+      x0 = minX;
+      y0 = minY;
+      nx = static_cast<std::size_t>(maxX - minX + 1);
+      ny = static_cast<std::size_t>(maxY - minY + 1);
+      values.assign(nx * ny, far);
+    }
+
+    bool empty() const { return values.empty(); }
+    hrleIndexType x1() const { return x0 + static_cast<hrleIndexType>(nx) - 1; }
+    hrleIndexType y1() const { return y0 + static_cast<hrleIndexType>(ny) - 1; }
+
+    NumericType &at(hrleIndexType x, hrleIndexType y) {
+      return values[(y - y0) * nx + (x - x0)];
+    }
+
+    // union with another field shifted by (dx, dy)
+    void merge(const DistanceField &other, hrleIndexType dx,
+               hrleIndexType dy) {
+      const auto xBegin = std::max(x0, other.x0 + dx);
+      const auto xEnd = std::min(x1(), other.x1() + dx);
+      const auto yBegin = std::max(y0, other.y0 + dy);
+      const auto yEnd = std::min(y1(), other.y1() + dy);
+      if (xBegin > xEnd || yBegin > yEnd)
+        return;
+      for (hrleIndexType y = yBegin; y <= yEnd; ++y) {
+        const auto *src =
+            &other.values[(y - dy - other.y0) * other.nx + (xBegin - dx) -
+                          other.x0];
+        auto *dst = &values[(y - y0) * nx + (xBegin - x0)];
+        for (hrleIndexType x = 0; x <= xEnd - xBegin; ++x)
+          dst[x] = std::min(dst[x], src[x]);
+      }
+    }
+
+    // Keep only points with a sign change to one of their eight neighbors.
+    // Edges shared by abutting or overlapping polygons otherwise leave small
+    // distances inside the union, which would form internal surfaces.
+    void prune() {
+      std::vector<char> inside(values.size());
+      for (std::size_t idx = 0; idx < values.size(); ++idx)
+        inside[idx] = std::signbit(values[idx]);
+
+      for (std::size_t j = 0; j < ny; ++j) {
+        for (std::size_t i = 0; i < nx; ++i) {
+          const auto idx = j * nx + i;
+          if (std::abs(values[idx]) > width)
+            continue;
+          bool boundary = false;
+          for (std::size_t nj = j > 0 ? j - 1 : 0;
+               nj <= std::min(j + 1, ny - 1) && !boundary; ++nj)
+            for (std::size_t ni = i > 0 ? i - 1 : 0;
+                 ni <= std::min(i + 1, nx - 1); ++ni)
+              if (inside[nj * nx + ni] != inside[idx]) {
+                boundary = true;
+                break;
+              }
+          if (!boundary)
+            values[idx] = inside[idx] ? -far : far;
+        }
+      }
+    }
+  };
+
+  // content of a layer: polygons and fields stamped at a grid offset
+  struct LayerContent {
+    std::vector<Polygon> polygons;
+    std::vector<std::pair<const DistanceField *, std::array<hrleIndexType, 2>>>
+        stamps;
+    std::vector<std::string> warnings;
+  };
+  using FieldCache = std::unordered_map<std::string, DistanceField>;
+
 public:
+  // Layer to be converted by layersToLevelSets.
+  struct LayerSpec {
+    int16_t layer;
+    NumericType baseHeight;
+    NumericType height;
+    bool mask = false;
+  };
+
   GDSGeometry() {
     if constexpr (D == 2) {
       Logger::getInstance()
@@ -63,81 +194,113 @@ public:
   lsDomainType layerToLevelSet(const int16_t layer,
                                const NumericType baseHeight,
                                const NumericType height, bool mask = false) {
+    std::vector<std::string> warnings;
+    auto levelSet = convertLayer(layer, baseHeight, height, mask, warnings);
+    printWarnings(warnings);
+    return levelSet;
+  }
 
-    auto levelSet = lsDomainType::New(bounds_, boundaryConds_, gridDelta_);
+  // Convert several layers concurrently. The level sets are returned in the
+  // order of the specs, e.g. to be inserted with
+  // Domain::insertNextLevelSetAsMaterial.
+  std::vector<lsDomainType>
+  layersToLevelSets(const std::vector<LayerSpec> &specs) {
+    // build the shared spatial index before the parallel region
+    if (useWindow_ && !structures.empty())
+      structureTree(structures.front());
+
+    std::vector<lsDomainType> levelSets(specs.size());
+    std::vector<std::vector<std::string>> warnings(specs.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(specs.size()); ++i) {
+      const auto &spec = specs[i];
+      levelSets[i] = convertLayer(spec.layer, spec.baseHeight, spec.height,
+                                  spec.mask, warnings[i]);
+    }
+    for (const auto &layerWarnings : warnings)
+      printWarnings(layerWarnings);
+    return levelSets;
+  }
 
-    for (auto &str : structures) { // loop over all structures
-      if (!str.isRef) {
-        // add single elements
-        if (auto contains = str.containsLayers.find(layer);
-            contains != str.containsLayers.end()) {
-          for (auto &el : str.elements) {
-            if (el.layer == layer) {
-              if (el.elementType == GDS::ElementType::elBox) {
-                addBox(levelSet, el, baseHeight, height, 0., 0.);
-              } else {
-                addPolygon(levelSet, el, baseHeight, height, 0, 0);
-              }
-            }
-          }
-        }
+  void printBound() const {
+    std::cout << "Geometry: (" << minBounds[0] << ", " << minBounds[1]
+              << ") - (" << maxBounds[0] << ", " << maxBounds[1] << ")"
+              << std::endl;
+  }
 
-        // add structure references
-        auto strMesh = SmartPointer<viennals::Mesh<NumericType>>::New();
-        for (auto &sref : str.sRefs) {
-          auto refStr = getStructure(sref.strName);
-          if (auto contains = refStr->containsLayers.find(layer);
-              contains != refStr->containsLayers.end()) {
-            assert(assembledStructures[refStr->name][layer]);
-
-            // copy mesh here
-            auto copy = assembledStructures[refStr->name][layer];
-            auto preBuiltStrMesh =
-                SmartPointer<viennals::Mesh<NumericType>>::New();
-            preBuiltStrMesh->nodes = copy->nodes;
-            preBuiltStrMesh->triangles = copy->triangles;
-            adjustPreBuiltMeshHeight(preBuiltStrMesh, baseHeight, height);
-
-            if (sref.angle > 0.) {
-              viennals::TransformMesh<NumericType>(
-                  preBuiltStrMesh, viennals::TransformEnum::ROTATION,
-                  hrleVectorType<double, 3>{0., 0., 1.}, deg2rad(sref.angle))
-                  .apply();
-            }
+  std::array<std::array<NumericType, 2>, 2> getBoundingBox() const {
+    return {minBounds, maxBounds};
+  }
 
-            if (sref.magnification > 0.) {
-              viennals::TransformMesh<NumericType>(
-                  preBuiltStrMesh, viennals::TransformEnum::SCALE,
-                  hrleVectorType<double, 3>{sref.magnification,
-                                            sref.magnification, 1.})
-                  .apply();
-            }
+  auto getBounds() { return bounds_; }
 
-            if (sref.flipped) {
-              Logger::getInstance()
-                  .addWarning("Flipping x-axis currently not supported.")
-                  .print();
-              continue;
-            }
+  const std::vector<GDS::Structure<NumericType>> &getStructures() const {
+    return structures;
+  }
+
+  void insertNextStructure(GDS::Structure<NumericType> const &structure) {
+    // the first structure with a name is used for references
+    structureIndex.insert({structure.name, structures.size()});
+    structures.push_back(structure);
+    structureTrees.clear();
+  }
 
-            viennals::TransformMesh<NumericType>(
-                preBuiltStrMesh, viennals::TransformEnum::TRANSLATION,
-                hrleVectorType<double, 3>{sref.refPoint[0], sref.refPoint[1],
-                                          0.})
-                .apply();
+  // Restrict the conversion to a region of interest. Only elements and
+  // references intersecting the window are converted and the domain bounds
+  // in x and y are set to the window.
+  void setSimulationWindow(const NumericType xMin, const NumericType yMin,
+                           const NumericType xMax, const NumericType yMax) {
+    window_ = {std::array<NumericType, 2>{xMin, yMin},
+               std::array<NumericType, 2>{xMax, yMax}};
+    useWindow_ = true;
+    updateBounds();
+  }
 
-            strMesh->append(*preBuiltStrMesh);
-          }
-        }
-        if (strMesh->nodes.size() > 0) {
-          auto tmpLS = lsDomainType::New(levelSet->getGrid());
-          viennals::FromSurfaceMesh<NumericType, D>(tmpLS, strMesh).apply();
-          viennals::BooleanOperation<NumericType, D>(
-              levelSet, tmpLS, viennals::BooleanOperationEnum::UNION)
-              .apply();
-        }
-      }
+  // Convert the whole layout again.
+  void clearSimulationWindow() {
+    useWindow_ = false;
+    updateBounds();
+  }
+
+  void finalize() {
+    checkReferences();
+    calculateBoundingBoxes();
+    structureTrees.clear();
+  }
+
+private:
+  // Warnings are returned instead of printed, since the Logger is not
+  // thread-safe and layers may be converted in parallel.
+  lsDomainType convertLayer(const int16_t layer, const NumericType baseHeight,
+                            const NumericType height, bool mask,
+                            std::vector<std::string> &warnings) {
+    // merge all top level structures on the xy-grid of the domain
+    FieldCache cache;
+    LayerContent content;
+    // include the narrow band around the window
+    BoundingBox window = window_;
+    for (int i = 0; i < 2; ++i) {
+      window[0][i] -= (width + 1) * gridDelta_;
+      window[1][i] += (width + 1) * gridDelta_;
+    }
+    for (auto &str : structures) {
+      if (!str.isRef)
+        collectLayer(str, layer, Transform{}, content, cache, 0,
+                     useWindow_ ? &window : nullptr);
+    }
+
+    DistanceField field;
+    {
+      auto gridLS = lsDomainType::New(bounds_, boundaryConds_, gridDelta_);
+      const auto &grid = gridLS->getGrid();
+      field.resize(grid.getMinGridPoint()[0], grid.getMinGridPoint()[1],
+                   grid.getMaxGridPoint()[0], grid.getMaxGridPoint()[1]);
     }
+    rasterize(content, field);
+    field.prune();
+    warnings = std::move(content.warnings);
+
+    auto levelSet = extrude(field, baseHeight, height);
 
     if (mask) {
       auto topPlane = lsDomainType::New(bounds_, boundaryConds_, gridDelta_);
@@ -170,80 +333,32 @@ public:
     return levelSet;
   }
 
-  void printBound() const {
-    std::cout << "Geometry: (" << minBounds[0] << ", " << minBounds[1]
-              << ") - (" << maxBounds[0] << ", " << maxBounds[1] << ")"
-              << std::endl;
-  }
-
-  std::array<std::array<NumericType, 2>, 2> getBoundingBox() const {
-    return {minBounds, maxBounds};
+  static void printWarnings(const std::vector<std::string> &warnings) {
+    for (const auto &warning : warnings)
+      Logger::getInstance().addWarning(warning).print();
   }
 
-  auto getBounds() { return bounds_; }
-
-  void insertNextStructure(GDS::Structure<NumericType> const &structure) {
-    structures.push_back(structure);
-  }
-
-  void finalize() {
-    checkReferences();
-    preBuildStructures();
-    calculateBoundingBoxes();
-  }
-
-private:
   GDS::Structure<NumericType> *getStructure(const std::string &strName) {
-    for (size_t i = 0; i < structures.size(); i++) {
-      if (strName == structures[i].name) {
-        return &structures[i];
-      }
-    }
+    if (auto it = structureIndex.find(strName); it != structureIndex.end())
+      return &structures[it->second];
     return nullptr;
   }
 
   void checkReferences() {
-    for (auto &str : structures) {
-      for (auto &sref : str.sRefs) {
-        auto refStr = getStructure(sref.strName);
+    auto markReferenced = [&](const std::string &strName) {
+      if (auto refStr = getStructure(strName)) {
         refStr->isRef = true;
+      } else {
+        Logger::getInstance()
+            .addWarning("Referenced structure " + strName + " not found.")
+            .print();
       }
-    }
-  }
-
-  void preBuildStructures() {
-    int n = 0;
+    };
     for (auto &str : structures) {
-      if (str.isRef) {
-        if (!str.sRefs.empty()) {
-          std::cerr << "Referenced structure contains references" << std::endl;
-          continue;
-        }
-
-        StructureLayers strLayerMapping;
-
-        for (auto layer : str.containsLayers) {
-          strLayerMapping.insert(
-              {layer, SmartPointer<viennals::Mesh<NumericType>>::New()});
-        }
-
-        for (auto &el : str.elements) {
-          SmartPointer<viennals::Mesh<NumericType>> mesh;
-          if (el.elementType == GDS::ElementType::elBox) {
-            mesh = boxToSurfaceMesh(el, 0, 1, 0, 0);
-          } else {
-            bool retry = false;
-            mesh = polygonToSurfaceMesh(el, 0, 1, 0, 0, retry);
-            if (retry) {
-              pointOrderFlag = !pointOrderFlag;
-              mesh = polygonToSurfaceMesh(el, 0, 1, 0, 0, retry);
-            }
-          }
-          strLayerMapping[el.layer]->append(*mesh);
-        }
-
-        assembledStructures.insert({str.name, strLayerMapping});
-      }
+      for (auto &sref : str.sRefs)
+        markReferenced(sref.strName);
+      for (auto &aref : str.aRefs)
+        markReferenced(aref.strName);
     }
   }
 
@@ -254,315 +369,514 @@ private:
     maxBounds[0] = std::numeric_limits<NumericType>::lowest();
     maxBounds[1] = std::numeric_limits<NumericType>::lowest();
 
-    size_t numStructures = structures.size();
-    std::unordered_map<std::string, bool> processed;
-    for (const auto &str : structures) {
-      processed.insert({str.name, false});
+    std::unordered_map<std::string, BoundingBox> boxes;
+    for (auto &str : structures) {
+      str.boundingBox = structureBoundingBox(str, boxes, 0);
+
+      if (!str.isRef) {
+        minBounds[0] = std::min(minBounds[0], str.boundingBox[0][0]);
+        minBounds[1] = std::min(minBounds[1], str.boundingBox[0][1]);
+        maxBounds[0] = std::max(maxBounds[0], str.boundingBox[1][0]);
+        maxBounds[1] = std::max(maxBounds[1], str.boundingBox[1][1]);
+      }
     }
+    updateBounds();
+  }
 
-    while (!std::all_of(processed.begin(), processed.end(),
-                        [](std::pair<const std::basic_string<char>, bool> &p) {
-                          return p.second;
-                        })) {
-      for (size_t i = 0; i < numStructures; i++) {
-        if (processed[structures[i].name])
-          continue;
+  void updateBounds() {
+    if (useWindow_) {
+      bounds_[0] = window_[0][0];
+      bounds_[1] = window_[1][0];
+      bounds_[2] = window_[0][1];
+      bounds_[3] = window_[1][1];
+    } else {
+      bounds_[0] = minBounds[0] - boundaryPadding[0];
+      bounds_[1] = maxBounds[0] + boundaryPadding[0];
+      bounds_[2] = minBounds[1] - boundaryPadding[1];
+      bounds_[3] = maxBounds[1] + boundaryPadding[1];
+    }
+    bounds_[4] = -1.;
+    bounds_[5] = 1.;
+  }
 
-        structures[i].boundingBox = structures[i].elementBoundingBox;
-        bool finish = true;
-        for (const auto sref : structures[i].sRefs) {
-          auto refStr = getStructure(sref.strName);
-          assert(refStr);
-          if (!processed[refStr->name]) {
-            finish = false;
-            break;
+  // Bounding box of the structure including all placed references.
+  BoundingBox
+  structureBoundingBox(const GDS::Structure<NumericType> &str,
+                       std::unordered_map<std::string, BoundingBox> &boxes,
+                       const unsigned depth) {
+    if (auto it = boxes.find(str.name); it != boxes.end())
+      return it->second;
+
+    BoundingBox box = str.elementBoundingBox;
+    if (depth <= maxReferenceDepth) {
+      forEachPlacement(str, [&](const GDS::Structure<NumericType> &refStr,
+                                const Transform &placement) {
+        const auto refBox = structureBoundingBox(refStr, boxes, depth + 1);
+        if (refBox[0][0] > refBox[1][0] || refBox[0][1] > refBox[1][1])
+          return;
+        for (const auto x : {refBox[0][0], refBox[1][0]}) {
+          for (const auto y : {refBox[0][1], refBox[1][1]}) {
+            const auto corner = placement.apply(x, y);
+            for (int i = 0; i < 2; ++i) {
+              box[0][i] = std::min(box[0][i], corner[i]);
+              box[1][i] = std::max(box[1][i], corner[i]);
+            }
           }
+        }
+      });
+    }
+    boxes.insert({str.name, box});
+    return box;
+  }
+
+  // Call func(structure, transform) for every SRef and every element of the
+  // ARef arrays in the structure. If a window in the coordinates of the
+  // structure is given, only placements intersecting it are visited.
+  template <class Func>
+  void forEachPlacement(const GDS::Structure<NumericType> &str, Func &&func,
+                        const BoundingBox *window = nullptr) {
+    if (window) {
+      const auto numElements = str.elements.size();
+      const auto numSRefs = str.sRefs.size();
+      structureTree(str).query(*window, [&](unsigned id) {
+        if (id < numElements)
+          return;
+        if (id < numElements + numSRefs) {
+          placeSRef(str.sRefs[id - numElements], func);
+        } else {
+          placeARef(str.aRefs[id - numElements - numSRefs], func, window);
+        }
+      });
+      return;
+    }
 
-          auto minPoint_x = sref.refPoint[0] - refStr->boundingBox[0][0];
-          auto minPoint_y = sref.refPoint[1] - refStr->boundingBox[0][1];
+    for (const auto &sref : str.sRefs)
+      placeSRef(sref, func);
+    for (const auto &aref : str.aRefs)
+      placeARef(aref, func, nullptr);
+  }
 
-          auto maxPoint_x = sref.refPoint[0] + refStr->boundingBox[1][0];
-          auto maxPoint_y = sref.refPoint[1] + refStr->boundingBox[1][1];
+  template <class Func>
+  void placeSRef(const GDS::SRef<NumericType> &sref, Func &&func) {
+    if (auto refStr = getStructure(sref.strName))
+      func(*refStr, referenceTransform(sref.angle, sref.magnification,
+                                       sref.flipped, sref.refPoint));
+  }
 
-          if (minPoint_x < structures[i].boundingBox[0][0]) {
-            structures[i].boundingBox[0][0] = minPoint_x;
-          }
-          if (minPoint_y < structures[i].boundingBox[0][1]) {
-            structures[i].boundingBox[0][1] = minPoint_y;
-          }
-          if (maxPoint_x > structures[i].boundingBox[1][0]) {
-            structures[i].boundingBox[1][0] = maxPoint_x;
-          }
-          if (maxPoint_y > structures[i].boundingBox[1][1]) {
-            structures[i].boundingBox[1][1] = maxPoint_y;
-          }
-        }
-        if (!finish)
+  template <class Func>
+  void placeARef(const GDS::ARef<NumericType> &aref, Func &&func,
+                 const BoundingBox *window) {
+    auto refStr = getStructure(aref.strName);
+    if (!refStr)
+      return;
+    const int rows = std::max<int>(aref.arrayDims[0], 1);
+    const int cols = std::max<int>(aref.arrayDims[1], 1);
+    // the reference points span the whole array
+    const auto &origin = aref.refPoints[0];
+    std::array<NumericType, 2> colStep, rowStep;
+    for (int i = 0; i < 2; ++i) {
+      colStep[i] = (aref.refPoints[1][i] - origin[i]) / cols;
+      rowStep[i] = (aref.refPoints[2][i] - origin[i]) / rows;
+    }
+    auto placement = referenceTransform(aref.angle, aref.magnification,
+                                        aref.flipped, origin);
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < cols; ++c) {
+        placement.t[0] = origin[0] + c * colStep[0] + r * rowStep[0];
+        placement.t[1] = origin[1] + c * colStep[1] + r * rowStep[1];
+        if (window && !GDS::RTree<NumericType>::intersects(
+                          transformBox(placement, refStr->boundingBox),
+                          *window))
           continue;
+        func(*refStr, placement);
+      }
+    }
+  }
 
-        if (!structures[i].isRef) {
-          if (structures[i].boundingBox[0][0] < minBounds[0]) {
-            minBounds[0] = structures[i].boundingBox[0][0];
-          }
-          if (structures[i].boundingBox[0][1] < minBounds[1]) {
-            minBounds[1] = structures[i].boundingBox[0][1];
-          }
-          if (structures[i].boundingBox[1][0] > maxBounds[0]) {
-            maxBounds[0] = structures[i].boundingBox[1][0];
-          }
-          if (structures[i].boundingBox[1][1] > maxBounds[1]) {
-            maxBounds[1] = structures[i].boundingBox[1][1];
-          }
+  // Axis aligned box around the transformed box.
+  static BoundingBox transformBox(const Transform &transform,
+                                  const BoundingBox &box) {
+    BoundingBox result = {std::array<NumericType, 2>{far, far},
+                          std::array<NumericType, 2>{-far, -far}};
+    for (const auto x : {box[0][0], box[1][0]}) {
+      for (const auto y : {box[0][1], box[1][1]}) {
+        const auto corner = transform.apply(x, y);
+        for (int i = 0; i < 2; ++i) {
+          result[0][i] = std::min(result[0][i], corner[i]);
+          result[1][i] = std::max(result[1][i], corner[i]);
         }
-
-        processed[structures[i].name] = true;
       }
     }
-    bounds_[0] = minBounds[0] - boundaryPadding[0];
-    bounds_[1] = maxBounds[0] + boundaryPadding[0];
-    bounds_[2] = minBounds[1] - boundaryPadding[1];
-    bounds_[3] = maxBounds[1] + boundaryPadding[1];
-    bounds_[4] = -1.;
-    bounds_[5] = 1.;
+    return result;
   }
 
-  void addBox(lsDomainType levelSet, GDS::Element<NumericType> &element,
-              const NumericType baseHeight, const NumericType height,
-              const NumericType xOffset, const NumericType yOffset) const {
-    auto tmpLS = lsDomainType::New(levelSet->getGrid());
-
-    auto minPoint = element.pointCloud[1];
-    minPoint[2] = baseHeight;
-    auto maxPoint = element.pointCloud[3];
-    maxPoint[2] = baseHeight + height;
-
-    viennals::MakeGeometry<NumericType, D>(
-        tmpLS, SmartPointer<viennals::Box<NumericType, D>>::New(
-                   minPoint.data(), maxPoint.data()))
-        .apply();
-    viennals::BooleanOperation<NumericType, D>(
-        levelSet, tmpLS, viennals::BooleanOperationEnum::UNION)
-        .apply();
-  }
-
-  void addPolygon(lsDomainType levelSet, GDS::Element<NumericType> &element,
-                  const NumericType baseHeight, const NumericType height,
-                  const NumericType xOffset, const NumericType yOffset) {
-    bool retry = false;
-    auto mesh = polygonToSurfaceMesh(element, baseHeight, height, xOffset,
-                                     yOffset, retry);
-    if (retry) {
-      pointOrderFlag = !pointOrderFlag;
-      mesh = polygonToSurfaceMesh(element, baseHeight, height, xOffset, yOffset,
-                                  retry);
-    }
-    auto tmpLS = lsDomainType::New(levelSet->getGrid());
-    viennals::FromSurfaceMesh<NumericType, D>(tmpLS, mesh).apply();
-    viennals::BooleanOperation<NumericType, D>(
-        levelSet, tmpLS, viennals::BooleanOperationEnum::UNION)
-        .apply();
-  }
-
-  SmartPointer<viennals::Mesh<NumericType>>
-  boxToSurfaceMesh(GDS::Element<NumericType> &element,
-                   const NumericType baseHeight, const NumericType height,
-                   const NumericType xOffset, const NumericType yOffset) {
-    auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
-
-    for (auto &point : element.pointCloud) {
-      point[0] += xOffset;
-      point[1] += yOffset;
-      point[2] = baseHeight;
-      mesh->insertNextNode(point);
-    }
-
-    for (auto &point : element.pointCloud) {
-      point[0] += xOffset;
-      point[1] += yOffset;
-      point[2] = baseHeight + height;
-      mesh->insertNextNode(point);
-    }
-
-    for (unsigned i = 0; i < 4; i++) {
-      mesh->insertNextTriangle(std::array<unsigned, 3>{i, i + 4, (i + 1) % 4});
-      mesh->insertNextTriangle(
-          std::array<unsigned, 3>{i + 4, (i + 4 + 1) % 4 + 4, (i + 4 + 1) % 4});
-    }
-    mesh->insertNextTriangle(std::array<unsigned, 3>{0, 1, 3});
-    mesh->insertNextTriangle(std::array<unsigned, 3>{1, 2, 3});
-    mesh->insertNextTriangle(std::array<unsigned, 3>{4, 7, 5});
-    mesh->insertNextTriangle(std::array<unsigned, 3>{5, 7, 6});
-
-    return mesh;
-  }
-
-  SmartPointer<viennals::Mesh<NumericType>>
-  polygonToSurfaceMesh(GDS::Element<NumericType> &element,
-                       const NumericType baseHeight, const NumericType height,
-                       const NumericType xOffset, const NumericType yOffset,
-                       bool &retry) {
-    auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
-
-    unsigned numPointsFlat = element.pointCloud.size();
-
-    // sidewalls
-    for (unsigned i = 0; i < numPointsFlat; i++) {
-      std::array<NumericType, 3> offsetPoint = element.pointCloud[i];
-      offsetPoint[0] += xOffset;
-      offsetPoint[1] += yOffset;
-      offsetPoint[2] = baseHeight;
-      mesh->insertNextNode(offsetPoint);
-
-      if (pointOrderFlag) {
-        mesh->insertNextTriangle(std::array<unsigned, 3>{
-            i, (i + 1) % numPointsFlat, i + numPointsFlat});
-      } else {
-        mesh->insertNextTriangle(std::array<unsigned, 3>{
-            i + numPointsFlat, (i + 1) % numPointsFlat, i});
+  static bool isEmpty(const BoundingBox &box) {
+    return box[0][0] > box[1][0] || box[0][1] > box[1][1];
+  }
+
+  // Spatial index over the elements and references of a structure. The
+  // indices of all structures are built on first use.
+  const GDS::RTree<NumericType> &
+  structureTree(const GDS::Structure<NumericType> &str) {
+    if (structureTrees.size() != structures.size()) {
+      structureTrees.resize(structures.size());
+      for (std::size_t i = 0; i < structures.size(); ++i)
+        structureTrees[i] = buildTree(structures[i]);
+    }
+    return structureTrees[&str - structures.data()];
+  }
+
+  GDS::RTree<NumericType> buildTree(const GDS::Structure<NumericType> &str) {
+    std::vector<std::pair<BoundingBox, unsigned>> items;
+    unsigned id = 0;
+    for (const auto &el : str.elements) {
+      BoundingBox box = {std::array<NumericType, 2>{far, far},
+                         std::array<NumericType, 2>{-far, -far}};
+      for (const auto &point : el.pointCloud) {
+        for (int i = 0; i < 2; ++i) {
+          box[0][i] = std::min(box[0][i], point[i]);
+          box[1][i] = std::max(box[1][i], point[i]);
+        }
       }
+      if (!isEmpty(box))
+        items.push_back({box, id});
+      ++id;
     }
+    for (const auto &sref : str.sRefs) {
+      BoundingBox box = {std::array<NumericType, 2>{far, far},
+                         std::array<NumericType, 2>{-far, -far}};
+      placeSRef(sref, [&](const GDS::Structure<NumericType> &refStr,
+                          const Transform &placement) {
+        if (!isEmpty(refStr.boundingBox))
+          box = transformBox(placement, refStr.boundingBox);
+      });
+      if (!isEmpty(box))
+        items.push_back({box, id});
+      ++id;
+    }
+    for (const auto &aref : str.aRefs) {
+      BoundingBox box = {std::array<NumericType, 2>{far, far},
+                         std::array<NumericType, 2>{-far, -far}};
+      placeARef(
+          aref,
+          [&](const GDS::Structure<NumericType> &refStr,
+              const Transform &placement) {
+            if (isEmpty(refStr.boundingBox))
+              return;
+            const auto instance = transformBox(placement, refStr.boundingBox);
+            for (int i = 0; i < 2; ++i) {
+              box[0][i] = std::min(box[0][i], instance[0][i]);
+              box[1][i] = std::max(box[1][i], instance[1][i]);
+            }
+          },
+          nullptr);
+      if (!isEmpty(box))
+        items.push_back({box, id});
+      ++id;
+    }
+    GDS::RTree<NumericType> tree;
+    tree.build(std::move(items));
+    return tree;
+  }
 
-    for (unsigned i = 0; i < numPointsFlat; i++) {
-      unsigned upPoint = i + numPointsFlat;
-      std::array<NumericType, 3> offsetPoint = element.pointCloud[i];
-      offsetPoint[0] += xOffset;
-      offsetPoint[1] += yOffset;
-      offsetPoint[2] = baseHeight + height;
-      mesh->insertNextNode(offsetPoint);
+  // GDS applies reflection about the x-axis, magnification, rotation and
+  // translation in this order.
+  static Transform referenceTransform(const NumericType angle,
+                                      const NumericType magnification,
+                                      const bool flipped,
+                                      const std::array<NumericType, 3> &point) {
+    const NumericType rad = deg2rad(angle);
+    const NumericType mag = magnification > 0. ? magnification : 1.;
+    const NumericType flip = flipped ? -1. : 1.;
+    Transform transform;
+    transform.m = {mag * std::cos(rad), -flip * mag * std::sin(rad),
+                   mag * std::sin(rad), flip * mag * std::cos(rad)};
+    transform.t = {point[0], point[1]};
+    return transform;
+  }
 
-      if (pointOrderFlag) {
-        mesh->insertNextTriangle(std::array<unsigned, 3>{
-            upPoint, (upPoint + 1) % numPointsFlat,
-            (upPoint + 1) % numPointsFlat + numPointsFlat});
+  // Add the polygons of a structure on the layer to the current collection.
+  // Grid aligned translations of referenced structures are stamped from a
+  // field that is rasterized only once per structure, all other placements
+  // are transformed polygon by polygon.
+  // If a window is given, only elements and placements intersecting it are
+  // collected. Placements that lie completely inside the window are
+  // collected without further clipping.
+  void collectLayer(const GDS::Structure<NumericType> &str,
+                    const int16_t layer, const Transform &transform,
+                    LayerContent &content, FieldCache &cache,
+                    const unsigned depth, const BoundingBox *window = nullptr) {
+    if (depth > maxReferenceDepth) {
+      content.warnings.push_back("GDS reference depth exceeded in " +
+                                 str.name + ".");
+      return;
+    }
+
+    auto addElement = [&](const GDS::Element<NumericType> &el) {
+      if (el.layer != layer || el.pointCloud.size() < 3)
+        return;
+      Polygon polygon;
+      polygon.reserve(el.pointCloud.size());
+      for (const auto &point : el.pointCloud) {
+        auto p = transform.apply(point[0], point[1]);
+        polygon.push_back({p[0] / gridDelta_, p[1] / gridDelta_});
+      }
+      content.polygons.push_back(std::move(polygon));
+    };
+
+    // window in the coordinates of the structure
+    BoundingBox localWindow;
+    if (window)
+      localWindow = transformBox(transform.inverse(), *window);
+
+    if (str.containsLayers.find(layer) != str.containsLayers.end()) {
+      if (window) {
+        structureTree(str).query(localWindow, [&](unsigned id) {
+          if (id < str.elements.size())
+            addElement(str.elements[id]);
+        });
       } else {
-        mesh->insertNextTriangle(std::array<unsigned, 3>{
-            (upPoint + 1) % numPointsFlat + numPointsFlat,
-            (upPoint + 1) % numPointsFlat, upPoint});
+        for (const auto &el : str.elements)
+          addElement(el);
       }
     }
 
-    // polygon triangulation (ear clipping algorithm)
-    std::vector<unsigned> leftNeighbors(numPointsFlat);
-    std::vector<unsigned> rightNeighbors(numPointsFlat);
+    forEachPlacement(
+        str,
+        [&](const GDS::Structure<NumericType> &refStr,
+            const Transform &placement) {
+          if (isEmpty(refStr.boundingBox))
+            return;
+          const auto combined = transform * placement;
+          const BoundingBox *refWindow = nullptr;
+          if (window) {
+            const auto box = transformBox(combined, refStr.boundingBox);
+            if (box[0][0] < (*window)[0][0] || box[0][1] < (*window)[0][1] ||
+                box[1][0] > (*window)[1][0] || box[1][1] > (*window)[1][1])
+              refWindow = window;
+          }
+          std::array<hrleIndexType, 2> offset;
+          if (!refWindow && combined.isTranslation() &&
+              isGridAligned(combined.t, offset)) {
+            const auto &field =
+                structureField(refStr, layer, cache, depth + 1);
+            if (!field.empty())
+              content.stamps.push_back({&field, offset});
+          } else {
+            collectLayer(refStr, layer, combined, content, cache, depth + 1,
+                         refWindow);
+          }
+        },
+        window ? &localWindow : nullptr);
+  }
 
-    // initialize neighbors
-    for (unsigned i = 0; i < numPointsFlat; i++) {
-      leftNeighbors[i] = ((i - 1) + numPointsFlat) % numPointsFlat;
-      rightNeighbors[i] = ((i + 1) + numPointsFlat) % numPointsFlat;
+  // Signed distance field of a structure in its own coordinate system.
+  const DistanceField &structureField(const GDS::Structure<NumericType> &str,
+                                      const int16_t layer, FieldCache &cache,
+                                      const unsigned depth) {
+    if (auto it = cache.find(str.name); it != cache.end())
+      return it->second;
+
+    LayerContent content;
+    collectLayer(str, layer, Transform{}, content, cache, depth);
+
+    // extent of all polygons and stamped fields
+    constexpr auto maxIndex = std::numeric_limits<hrleIndexType>::max();
+    std::array<hrleIndexType, 2> lower = {maxIndex, maxIndex};
+    std::array<hrleIndexType, 2> upper = {-maxIndex, -maxIndex};
+    for (const auto &polygon : content.polygons) {
+      for (const auto &point : polygon) {
+        for (int i = 0; i < 2; ++i) {
+          lower[i] = std::min<hrleIndexType>(lower[i],
+                                             std::floor(point[i] - width));
+          upper[i] =
+              std::max<hrleIndexType>(upper[i], std::ceil(point[i] + width));
+        }
+      }
+    }
+    for (const auto &[field, offset] : content.stamps) {
+      lower[0] = std::min(lower[0], field->x0 + offset[0]);
+      lower[1] = std::min(lower[1], field->y0 + offset[1]);
+      upper[0] = std::max(upper[0], field->x1() + offset[0]);
+      upper[1] = std::max(upper[1], field->y1() + offset[1]);
     }
 
-    unsigned numTriangles = 0;
-    unsigned i = numPointsFlat - 1;
-    unsigned counter = 0;
-    while (numTriangles < (numPointsFlat - 2)) {
-      i = rightNeighbors[i];
-      if (isEar(leftNeighbors[i], i, rightNeighbors[i], mesh, numPointsFlat)) {
-        if (pointOrderFlag) {
-
-          mesh->insertNextTriangle(
-              std::array<unsigned, 3>{rightNeighbors[i], i, leftNeighbors[i]});
-        } else {
-          mesh->insertNextTriangle(
-              std::array<unsigned, 3>{leftNeighbors[i], i, rightNeighbors[i]});
-        }
+    DistanceField field;
+    if (lower[0] <= upper[0] && lower[1] <= upper[1]) {
+      field.resize(lower[0], lower[1], upper[0], upper[1]);
+      rasterize(content, field);
+    }
+    return cache.emplace(str.name, std::move(field)).first->second;
+  }
 
-        // remove point
-        leftNeighbors[rightNeighbors[i]] = leftNeighbors[i];
-        rightNeighbors[leftNeighbors[i]] = rightNeighbors[i];
+  bool isGridAligned(const std::array<NumericType, 2> &translation,
+                     std::array<hrleIndexType, 2> &offset) const {
+    for (int i = 0; i < 2; ++i) {
+      const NumericType shift = translation[i] / gridDelta_;
+      offset[i] = static_cast<hrleIndexType>(std::round(shift));
+      if (std::abs(shift - offset[i]) > 1e-4)
+        return false;
+    }
+    return true;
+  }
 
-        numTriangles++;
+  // Merge the polygons and stamped fields into the field. The union is the
+  // minimum of the individual signed distances, which is only exact outside
+  // the union, so the merged field has to be pruned.
+  void rasterize(const LayerContent &content, DistanceField &field) const {
+    std::vector<NumericType> distance;
+    std::vector<char> inside;
+    std::vector<NumericType> crossings;
+
+    for (const auto &points : content.polygons) {
+      const auto numPoints = points.size();
+      std::array<NumericType, 2> pMin = {far, far}, pMax = {-far, -far};
+      for (const auto &point : points) {
+        for (int i = 0; i < 2; ++i) {
+          pMin[i] = std::min(pMin[i], point[i]);
+          pMax[i] = std::max(pMax[i], point[i]);
+        }
       }
-
-      if (counter++ > triangulationTimeOut) {
-        if (!retry) {
-          retry = true;
-          return mesh;
-        } else {
-          Logger::getInstance()
-              .addError("Timeout in surface triangulation.")
-              .print();
+      const auto x0 =
+          std::max<hrleIndexType>(field.x0, std::floor(pMin[0] - width));
+      const auto x1 =
+          std::min<hrleIndexType>(field.x1(), std::ceil(pMax[0] + width));
+      const auto y0 =
+          std::max<hrleIndexType>(field.y0, std::floor(pMin[1] - width));
+      const auto y1 =
+          std::min<hrleIndexType>(field.y1(), std::ceil(pMax[1] + width));
+      if (x0 > x1 || y0 > y1)
+        continue;
+      const auto localNx = static_cast<std::size_t>(x1 - x0 + 1);
+      const auto localNy = static_cast<std::size_t>(y1 - y0 + 1);
+      distance.assign(localNx * localNy, far);
+      inside.assign(localNx * localNy, 0);
+
+      // unsigned distance to the edges in a narrow band
+      for (std::size_t e = 0; e < numPoints; ++e) {
+        const auto &a = points[e];
+        const auto &b = points[(e + 1) % numPoints];
+        const auto ex0 = std::max<hrleIndexType>(
+            x0, std::floor(std::min(a[0], b[0]) - width));
+        const auto ex1 = std::min<hrleIndexType>(
+            x1, std::ceil(std::max(a[0], b[0]) + width));
+        const auto ey0 = std::max<hrleIndexType>(
+            y0, std::floor(std::min(a[1], b[1]) - width));
+        const auto ey1 = std::min<hrleIndexType>(
+            y1, std::ceil(std::max(a[1], b[1]) + width));
+        for (hrleIndexType y = ey0; y <= ey1; ++y) {
+          for (hrleIndexType x = ex0; x <= ex1; ++x) {
+            const auto idx = (y - y0) * localNx + (x - x0);
+            distance[idx] =
+                std::min(distance[idx], segmentDistance(x, y, a, b));
+          }
         }
       }
-    }
 
-    // use same triangles for other side
-    auto &triangles = mesh->template getElements<3>();
-    unsigned numPrevTriangles = triangles.size() - 1;
-    for (unsigned j = 0; j < numTriangles; j++) {
-      auto triangle = triangles[numPrevTriangles - j];
-      for (int d = 0; d < 3; d++) {
-        triangle[d] += numPointsFlat;
+      // interior with an even-odd scanline
+      for (hrleIndexType y = y0; y <= y1; ++y) {
+        crossings.clear();
+        for (std::size_t e = 0; e < numPoints; ++e) {
+          const auto &a = points[e];
+          const auto &b = points[(e + 1) % numPoints];
+          if ((a[1] <= y) != (b[1] <= y))
+            crossings.push_back(a[0] + (y - a[1]) * (b[0] - a[0]) /
+                                           (b[1] - a[1]));
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (std::size_t c = 0; c + 1 < crossings.size(); c += 2) {
+          const auto cx0 = std::max<hrleIndexType>(x0, std::ceil(crossings[c]));
+          const auto cx1 =
+              std::min<hrleIndexType>(x1, std::floor(crossings[c + 1]));
+          for (hrleIndexType x = cx0; x <= cx1; ++x)
+            inside[(y - y0) * localNx + (x - x0)] = 1;
+        }
       }
-      std::swap(triangle[0], triangle[2]); // swap for correct orientation
-      mesh->insertNextTriangle(triangle);
-    }
-
-    return mesh;
-  }
-
-  bool isEar(int i, int j, int k,
-             SmartPointer<viennals::Mesh<NumericType>> mesh,
-             unsigned numPoints) const {
-    auto &points = mesh->getNodes();
-
-    // check if triangle is clockwise orientated
-    if (((points[i][0] * points[j][1] + points[i][1] * points[k][0] +
-          points[j][0] * points[k][1] - points[k][0] * points[j][1] -
-          points[k][1] * points[i][0] - points[j][0] * points[i][1]) < 0.) !=
-        !pointOrderFlag)
-      return false;
-
-    for (unsigned m = 0; m < numPoints; m++) {
-      if ((m != i) && (m != j) && (m != k)) {
-        // check if point in triangle
-        auto side_1 =
-            (points[m][0] - points[j][0]) * (points[i][1] - points[j][1]) -
-            (points[i][0] - points[j][0]) * (points[m][1] - points[j][1]);
-        // Segment B to C
-        auto side_2 =
-            (points[m][0] - points[k][0]) * (points[j][1] - points[k][1]) -
-            (points[j][0] - points[k][0]) * (points[m][1] - points[k][1]);
-        // Segment C to A
-        auto side_3 =
-            (points[m][0] - points[i][0]) * (points[k][1] - points[i][1]) -
-            (points[k][0] - points[i][0]) * (points[m][1] - points[i][1]);
-
-        // All the signs must be positive or all negative
-        if (((side_1 < eps) && (side_2 < eps) && (side_3 < eps)) ||
-            ((side_1 > -eps) && (side_2 > -eps) && (side_3 > -eps)))
-          return false;
+
+      // merge with the other polygons
+      for (std::size_t j = 0; j < localNy; ++j) {
+        for (std::size_t i = 0; i < localNx; ++i) {
+          const auto idx = j * localNx + i;
+          const NumericType value =
+              inside[idx] ? -distance[idx] : distance[idx];
+          auto &merged = field.at(x0 + i, y0 + j);
+          merged = std::min(merged, value);
+        }
       }
     }
 
-    return true;
+    for (const auto &[stamp, offset] : content.stamps)
+      field.merge(*stamp, offset[0], offset[1]);
   }
 
-  void adjustPreBuiltMeshHeight(SmartPointer<viennals::Mesh<NumericType>> mesh,
-                                const NumericType baseHeight,
-                                const NumericType height) const {
-    auto &nodes = mesh->getNodes();
+  // Create the level set of the 2D field extruded from baseHeight to
+  // baseHeight + height. The signed distance of the extruded shape is
+  // evaluated directly at the grid points close to the surface.
+  lsDomainType extrude(const DistanceField &field,
+                       const NumericType baseHeight, const NumericType height) {
+    auto levelSet = lsDomainType::New(bounds_, boundaryConds_, gridDelta_);
 
-    for (auto &n : nodes) {
-      if (n[2] < 1.) {
-        n[2] = baseHeight;
-      } else {
-        n[2] = baseHeight + height;
+    const NumericType zBottom = baseHeight / gridDelta_;
+    const NumericType zTop = (baseHeight + height) / gridDelta_;
+    const auto kMin = static_cast<hrleIndexType>(std::ceil(zBottom - width));
+    const auto kMax = static_cast<hrleIndexType>(std::floor(zTop + width));
+    const auto kBottomMax =
+        static_cast<hrleIndexType>(std::floor(zBottom + width));
+    const auto kTopMin = static_cast<hrleIndexType>(std::ceil(zTop - width));
+
+    typename viennals::Domain<NumericType, D>::PointValueVectorType points;
+    hrleVectorType<hrleIndexType, D> index;
+    for (std::size_t j = 0; j < field.ny; ++j) {
+      for (std::size_t i = 0; i < field.nx; ++i) {
+        const NumericType d2 = field.values[j * field.nx + i];
+        if (d2 > width)
+          continue;
+        index[0] = field.x0 + static_cast<hrleIndexType>(i);
+        index[1] = field.y0 + static_cast<hrleIndexType>(j);
+
+        auto addPoint = [&](hrleIndexType k) {
+          const NumericType dz = std::max(zBottom - k, k - zTop);
+          const NumericType value =
+              (d2 <= 0. && dz <= 0.)
+                  ? std::max(d2, dz)
+                  : std::sqrt(std::pow(std::max(d2, NumericType(0)), 2) +
+                              std::pow(std::max(dz, NumericType(0)), 2));
+          if (std::abs(value) <= width) {
+            index[2] = k;
+            points.push_back(std::make_pair(index, value));
+          }
+        };
+
+        if (d2 < -width) {
+          // interior column: only the bottom and top faces
+          for (auto k = kMin; k <= kBottomMax; ++k)
+            addPoint(k);
+          for (auto k = std::max(kTopMin, kBottomMax + 1); k <= kMax; ++k)
+            addPoint(k);
+        } else {
+          for (auto k = kMin; k <= kMax; ++k)
+            addPoint(k);
+        }
       }
     }
-  }
 
-  void resetPreBuiltMeshHeight(SmartPointer<viennals::Mesh<NumericType>> mesh,
-                               const NumericType baseHeight,
-                               const NumericType height) const {
-    auto &nodes = mesh->getNodes();
+    levelSet->insertPoints(points);
+    return levelSet;
+  }
 
-    for (auto &n : nodes) {
-      if (n[2] == baseHeight) {
-        n[2] = 0.;
-      } else {
-        n[2] = 1.;
-      }
-    }
+  static NumericType segmentDistance(const NumericType x, const NumericType y,
+                                     const std::array<NumericType, 2> &a,
+                                     const std::array<NumericType, 2> &b) {
+    const NumericType abX = b[0] - a[0];
+    const NumericType abY = b[1] - a[1];
+    const NumericType lengthSquared = abX * abX + abY * abY;
+    NumericType t = 0.;
+    if (lengthSquared > 0.)
+      t = std::clamp(((x - a[0]) * abX + (y - a[1]) * abY) / lengthSquared,
+                     NumericType(0), NumericType(1));
+    const NumericType dX = a[0] + t * abX - x;
+    const NumericType dY = a[1] + t * abY - y;
+    return std::sqrt(dX * dX + dY * dY);
   }
 
   static inline NumericType deg2rad(const NumericType angleDeg) {
@@ -571,13 +885,13 @@ private:
 
 private:
   std::vector<GDS::Structure<NumericType>> structures;
-  std::unordered_map<std::string, StructureLayers> assembledStructures;
+  std::unordered_map<std::string, std::size_t> structureIndex;
+  std::vector<GDS::RTree<NumericType>> structureTrees;
+  BoundingBox window_;
+  bool useWindow_ = false;
   std::array<NumericType, 2> boundaryPadding = {0., 0.};
-  std::array<NumericType, 2> minBounds;
-  std::array<NumericType, 2> maxBounds;
-  static bool pointOrderFlag;
-  unsigned triangulationTimeOut = 1000000;
-  static constexpr double eps = 1e-6;
+  std::array<NumericType, 2> minBounds = {0., 0.};
+  std::array<NumericType, 2> maxBounds = {0., 0.};
 
   double bounds_[6];
   NumericType gridDelta_ = 1.;
@@ -586,7 +900,4 @@ private:
                                     BoundaryType::INFINITE_BOUNDARY};
 };
 
-template <class NumericType, int D>
-bool GDSGeometry<NumericType, D>::pointOrderFlag = true;
-
 } // namespace viennaps
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
-#include <cstdio>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <string>
+#include <string_view>
 
 #include "psGDSGeometry.hpp"
 #include "psGDSUtils.hpp"
+#include "psMappedFile.hpp"
 
 #include <vcLogger.hpp>
 
@@ -16,7 +19,10 @@ using namespace viennacore;
 /// This class reads a GDS file and creates a GDSGeometry object. It is a
 /// very simple implementation and does not support all GDS features.
 template <typename NumericType, int D = 3> class GDSReader {
-  FILE *filePtr = nullptr;
+  utils::MappedFile file;
+  const unsigned char *buffer = nullptr;
+  std::size_t position = 0;
+  std::size_t recordEnd = 0;
   SmartPointer<GDSGeometry<NumericType, D>> geometry = nullptr;
   std::string fileName;
 
@@ -49,7 +55,7 @@ public:
 private:
   GDS::Structure<NumericType> currentStructure;
 
-  int16_t currentRecordLen = 0;
+  int32_t currentRecordLen = 0;
   int16_t currentLayer;
   int16_t currentDataType;
   int16_t currentPlexNumber;
@@ -64,7 +70,9 @@ private:
 
   // unused
   float currentWidth;
-  char *tempStr;
+
+  // decoded coordinates of the current XY record
+  std::vector<int32_t> xyBuffer;
 
   bool contains(int32_t X, int32_t Y,
                 const std::vector<std::array<int32_t, 2>> &uniPoints) {
@@ -96,55 +104,60 @@ private:
         std::numeric_limits<NumericType>::lowest();
   }
 
-  char *readAsciiString() {
-    char *str = NULL;
+  // Returns a view into the mapped file, valid until the file is closed.
+  std::string_view readAsciiString() {
+    std::string_view str;
 
     if (currentRecordLen > 0) {
-      currentRecordLen += currentRecordLen % 2;
-      str = new char[currentRecordLen + 1];
-
-      (void)!fread(str, 1, currentRecordLen, filePtr);
-      str[currentRecordLen] = 0;
+      auto begin = reinterpret_cast<const char *>(buffer + position);
+      // strings are usually padded with a zero to an even length, the next
+      // record starts at the record length in any case
+      std::size_t len = 0;
+      while (len < static_cast<std::size_t>(currentRecordLen) && begin[len])
+        ++len;
+      str = std::string_view(begin, len);
+      position += currentRecordLen;
       currentRecordLen = 0;
     }
 
     return str;
   }
 
-  int16_t readTwoByteSignedInt() {
-    int16_t value;
-    (void)!fread(&value, 2, 1, filePtr);
+  bool canRead(std::size_t numBytes) {
+    if (position + numBytes > recordEnd) {
+      currentRecordLen = 0;
+      return false;
+    }
+    return true;
+  }
 
+  int16_t readTwoByteSignedInt() {
+    if (!canRead(2))
+      return 0;
+    auto value = GDS::decodeInt16(buffer + position);
+    position += 2;
     currentRecordLen -= 2;
-
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-    return endian_swap_short(value);
-#else
     return value;
-#endif
   }
 
   int32_t readFourByteSignedInt() {
-    int32_t value;
-    (void)!fread(&value, 4, 1, filePtr);
-
+    if (!canRead(4))
+      return 0;
+    auto value = GDS::decodeInt32(buffer + position);
+    position += 4;
     currentRecordLen -= 4;
-
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-    return endian_swap_long(value);
-#else
     return value;
-#endif
   }
 
   double readEightByteReal() {
-    unsigned char value;
-    std::array<unsigned char, 7> bytes;
+    if (!canRead(8))
+      return 0.;
+    const unsigned char *bytes = buffer + position;
+    unsigned char value = bytes[0];
     double sign = 1.0;
     double exponent;
     double mant;
 
-    (void)!fread(&value, 1, 1, filePtr);
     if (value & 128) {
       value -= 128;
       sign = -1.0;
@@ -153,20 +166,32 @@ private:
     exponent -= 64.0;
     mant = 0.0;
 
-    for (int i = 0; i < 7; i++) {
-      (void)!fread(&bytes[i], 1, 1, filePtr);
-    }
-
-    for (int i = 6; i >= 0; i--) {
+    for (int i = 7; i >= 1; i--) {
       mant += static_cast<double>(bytes[i]);
       mant /= 256.0;
     }
 
+    position += 8;
     currentRecordLen -= 8;
 
     return sign * (mant * std::pow(16.0, exponent));
   }
 
+  // Decode all coordinates of the current record at once.
+  void readXYRecord() {
+    const std::size_t numValues = currentRecordLen / 4;
+    xyBuffer.resize(numValues);
+    if (!canRead(numValues * 4)) {
+      xyBuffer.clear();
+      return;
+    }
+    const unsigned char *ptr = buffer + position;
+    for (std::size_t i = 0; i < numValues; ++i)
+      xyBuffer[i] = GDS::decodeInt32(ptr + 4 * i);
+    position += numValues * 4;
+    currentRecordLen -= static_cast<int32_t>(numValues * 4);
+  }
+
   void parseHeader() {
     short version;
     version = readTwoByteSignedInt();
@@ -176,12 +201,10 @@ private:
   }
 
   void parseLibName() {
-    char *str;
-    str = readAsciiString();
+    auto str = readAsciiString();
     Logger::getInstance()
         .addDebug("GDS Library name: " + std::string(str))
         .print();
-    delete[] str;
   }
 
   void parseUnits() {
@@ -191,38 +214,37 @@ private:
   }
 
   void parseStructureName() {
-    char *str = readAsciiString();
+    auto str = readAsciiString();
 
-    if (str) {
+    if (!str.empty()) {
       currentStructure.name = str;
-      delete[] str;
     }
   }
 
   void parseSName() {
     // parse the structure reference
-    char *str = readAsciiString();
-    if (str) {
+    auto str = readAsciiString();
+    if (!str.empty()) {
       if (currentElement == GDS::ElementType::elSRef) {
         currentStructure.sRefs.back().strName = str;
       } else if (currentElement == GDS::ElementType::elARef) {
         currentStructure.aRefs.back().strName = str;
       }
-      delete[] str;
     }
   }
 
   void parseXYBoundary() {
     float X, Y;
-    unsigned int numPoints = currentRecordLen / 8;
+    readXYRecord();
+    const std::size_t numPoints = xyBuffer.size() / 2;
     auto &currentElPointCloud = currentStructure.elements.back().pointCloud;
     std::vector<std::array<int32_t, 2>> uniquePoints;
 
     // do not include the last point since it
     // is just a copy of the first
-    for (unsigned int i = 0; i < numPoints - 1; i++) {
-      auto pX = readFourByteSignedInt();
-      auto pY = readFourByteSignedInt();
+    for (std::size_t i = 0; i + 1 < numPoints; i++) {
+      auto pX = xyBuffer[2 * i];
+      auto pY = xyBuffer[2 * i + 1];
 
       if (!contains(pX, pY, uniquePoints)) {
         uniquePoints.push_back({pX, pY});
@@ -248,15 +270,11 @@ private:
         }
       }
     }
-    readFourByteSignedInt(); // parse remaining points
-    readFourByteSignedInt();
   }
 
   void parseXYIgnore() {
-    unsigned int numPoints = currentRecordLen / 8;
-    for (unsigned int i = 0; i < numPoints * 2; i++) {
-      readFourByteSignedInt();
-    }
+    position += currentRecordLen;
+    currentRecordLen = 0;
   }
 
   void parseXYRef() {
@@ -302,20 +320,41 @@ private:
   }
 
   void parseFile() {
-    filePtr = fopen(fileName.c_str(), "rb");
-    if (!filePtr) {
+    if (!file.open(fileName)) {
       Logger::getInstance().addError("Could not open GDS file.").print();
       return;
     }
+    buffer = file.data();
+    position = 0;
 
     unsigned char recordType, dataType;
     resetCurrentStructure();
 
-    while (!feof(filePtr)) {
-      currentRecordLen = readTwoByteSignedInt();
-      (void)!fread(&recordType, 1, 1, filePtr);
-      (void)!fread(&dataType, 1, 1, filePtr);
-      currentRecordLen -= 4;
+    while (position + 4 <= file.size()) {
+      const auto recordStart = position;
+      const auto recordLen =
+          static_cast<uint16_t>(GDS::decodeInt16(buffer + position));
+      recordType = buffer[position + 2];
+      dataType = buffer[position + 3];
+      position += 4;
+      if (recordLen < 4) {
+        // zero padding after the end of the library
+        if (recordLen == 0)
+          break;
+        Logger::getInstance()
+            .addWarning("Invalid record length in GDS file.")
+            .print();
+        break;
+      }
+      if (recordStart + recordLen > file.size()) {
+        // the structure in progress is incomplete and dropped
+        Logger::getInstance()
+            .addWarning("Truncated record in GDS file.")
+            .print();
+        break;
+      }
+      recordEnd = recordStart + recordLen;
+      currentRecordLen = static_cast<int32_t>(recordEnd - position);
 
       switch (static_cast<GDS::RecordNumbers>(recordType)) {
       case GDS::RecordNumbers::Header:
@@ -336,7 +375,7 @@ private:
         break;
 
       case GDS::RecordNumbers::EndLib:
-        fseek(filePtr, 0, SEEK_END);
+        closeFile();
         return;
 
       case GDS::RecordNumbers::BgnStr: // begin structure
@@ -454,8 +493,7 @@ private:
         break;
 
       case GDS::RecordNumbers::String: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::Path: // ignore
@@ -501,13 +539,11 @@ private:
         break;
 
       case GDS::RecordNumbers::RefLibs: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::Fonts: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::Generations: // ignore
@@ -515,8 +551,7 @@ private:
           readTwoByteSignedInt();
         break;
       case GDS::RecordNumbers::AttrTable: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::StypTable: // ignore
@@ -524,8 +559,7 @@ private:
         break;
 
       case GDS::RecordNumbers::StrType: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::LinkType: // ignore
@@ -549,8 +583,7 @@ private:
         break;
 
       case GDS::RecordNumbers::PropValue: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::BgnExtn: // ignore
@@ -586,8 +619,7 @@ private:
         break;
 
       case GDS::RecordNumbers::Mask: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::EndMasks: // ignore
@@ -600,8 +632,7 @@ private:
         break;
 
       case GDS::RecordNumbers::SrfName: // ignore
-        tempStr = readAsciiString();
-        delete[] tempStr;
+        readAsciiString();
         break;
 
       case GDS::RecordNumbers::LibSecur: // ignore
@@ -653,9 +684,21 @@ private:
         Logger::getInstance()
             .addWarning("Unknown record type in GDS file.")
             .print();
+        closeFile();
         return;
       }
+
+      // skip any unread data of the record
+      position = recordEnd;
     }
+    closeFile();
+  }
+
+  void closeFile() {
+    file.close();
+    buffer = nullptr;
+    position = 0;
+    recordEnd = 0;
   }
 };
 
@@ -1,20 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <set>
 #include <string>
 #include <vector>
 
-#ifndef endian_swap_long
-#define endian_swap_long(w)                                                    \
-  (((w & 0xff) << 24) | ((w & 0xff00) << 8) | ((w & 0xff0000) >> 8) |          \
-   ((w & 0xff000000) >> 24))
-#endif
-#ifndef endian_swap_short
-#define endian_swap_short(w) (((w & 0xff) << 8) | ((w & 0xff00) >> 8))
-#endif
+#include "psUtils.hpp"
 
 namespace viennaps {
 
@@ -103,6 +99,120 @@ enum class RecordNumbers {
   Contact /* 69 */
 };
 
+// GDS stores all values big-endian, independent of the host byte order.
+inline int16_t decodeInt16(const unsigned char *ptr) {
+  return static_cast<int16_t>(static_cast<uint16_t>(ptr[0] << 8 | ptr[1]));
+}
+
+inline int32_t decodeInt32(const unsigned char *ptr) {
+  return static_cast<int32_t>(
+      static_cast<uint32_t>(ptr[0]) << 24 |
+      static_cast<uint32_t>(ptr[1]) << 16 |
+      static_cast<uint32_t>(ptr[2]) << 8 | static_cast<uint32_t>(ptr[3]));
+}
+
+// Static R-tree over axis aligned boxes, bulk loaded with the
+// sort-tile-recursive algorithm.
+template <class T> class RTree {
+public:
+  using Box = std::array<std::array<T, 2>, 2>;
+
+  static bool intersects(const Box &a, const Box &b) {
+    return a[0][0] <= b[1][0] && b[0][0] <= a[1][0] && a[0][1] <= b[1][1] &&
+           b[0][1] <= a[1][1];
+  }
+
+  void build(std::vector<std::pair<Box, unsigned>> items) {
+    items_ = std::move(items);
+    nodes_.clear();
+    if (items_.empty())
+      return;
+
+    auto center = [](const Box &box, int axis) {
+      return box[0][axis] + box[1][axis];
+    };
+
+    // sort into vertical slices by x, then each slice by y
+    const std::size_t numLeaves =
+        (items_.size() + nodeCapacity - 1) / nodeCapacity;
+    const auto numSlices = static_cast<std::size_t>(
+        std::ceil(std::sqrt(static_cast<double>(numLeaves))));
+    const std::size_t sliceSize = numSlices * nodeCapacity;
+    std::sort(items_.begin(), items_.end(), [&](const auto &a, const auto &b) {
+      return center(a.first, 0) < center(b.first, 0);
+    });
+    for (std::size_t i = 0; i < items_.size(); i += sliceSize) {
+      auto end = items_.begin() + std::min(i + sliceSize, items_.size());
+      std::sort(items_.begin() + i, end, [&](const auto &a, const auto &b) {
+        return center(a.first, 1) < center(b.first, 1);
+      });
+    }
+
+    // leaves reference ranges of items, upper levels ranges of nodes
+    for (std::size_t i = 0; i < items_.size(); i += nodeCapacity) {
+      const auto end = std::min(i + nodeCapacity, items_.size());
+      Node node{items_[i].first, static_cast<unsigned>(i),
+                static_cast<unsigned>(end), true};
+      for (auto j = i + 1; j < end; ++j)
+        node.box = merge(node.box, items_[j].first);
+      nodes_.push_back(node);
+    }
+    std::size_t levelBegin = 0;
+    while (nodes_.size() - levelBegin > 1) {
+      const auto levelEnd = nodes_.size();
+      for (auto i = levelBegin; i < levelEnd; i += nodeCapacity) {
+        const auto end = std::min(i + nodeCapacity, levelEnd);
+        Node node{nodes_[i].box, static_cast<unsigned>(i),
+                  static_cast<unsigned>(end), false};
+        for (auto j = i + 1; j < end; ++j)
+          node.box = merge(node.box, nodes_[j].box);
+        nodes_.push_back(node);
+      }
+      levelBegin = levelEnd;
+    }
+  }
+
+  // Call func(id) for every item intersecting the window.
+  template <class Func> void query(const Box &window, Func &&func) const {
+    if (nodes_.empty())
+      return;
+    std::vector<unsigned> stack = {static_cast<unsigned>(nodes_.size() - 1)};
+    while (!stack.empty()) {
+      const auto &node = nodes_[stack.back()];
+      stack.pop_back();
+      if (!intersects(node.box, window))
+        continue;
+      for (auto i = node.begin; i < node.end; ++i) {
+        if (!node.leaf) {
+          stack.push_back(i);
+        } else if (intersects(items_[i].first, window)) {
+          func(items_[i].second);
+        }
+      }
+    }
+  }
+
+  bool empty() const { return items_.empty(); }
+
+private:
+  struct Node {
+    Box box;
+    unsigned begin, end;
+    bool leaf;
+  };
+
+  static Box merge(const Box &a, const Box &b) {
+    return {std::array<T, 2>{std::min(a[0][0], b[0][0]),
+                             std::min(a[0][1], b[0][1])},
+            std::array<T, 2>{std::max(a[1][0], b[1][0]),
+                             std::max(a[1][1], b[1][1])}};
+  }
+
+  static constexpr std::size_t nodeCapacity = 16;
+  std::vector<Node> nodes_;
+  std::vector<std::pair<Box, unsigned>> items_;
+};
+
 template <class T> struct Element {
   ElementType elementType;
   int16_t layer;
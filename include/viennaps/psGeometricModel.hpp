@@ -2,8 +2,12 @@
 
 #include "psDomain.hpp"
 
+#include <lsBooleanOperation.hpp>
+
 #include <vcSmartPointer.hpp>
 
+#include <algorithm>
+
 namespace viennaps {
 
 using namespace viennacore;
@@ -11,6 +15,7 @@ using namespace viennacore;
 template <typename NumericType, int D> class GeometricModel {
 protected:
   SmartPointer<Domain<NumericType, D>> domain = nullptr;
+  NumericType processDuration = 0.;
 
 public:
   virtual ~GeometricModel() = default;
@@ -19,7 +24,50 @@ public:
     domain = passedDomain;
   }
 
+  // Duration of the process the model is applied in. Geometric models which
+  // replace a rate based process use it to compute the final surface.
+  void setProcessDuration(NumericType passedDuration) {
+    processDuration = passedDuration;
+  }
+
   virtual void apply() {}
+
+protected:
+  // Level set enclosing the regions of all passed materials in the domain.
+  // Returns a nullptr if none of the materials are present.
+  SmartPointer<viennals::Domain<NumericType, D>>
+  makeMaterialLevelSet(const std::vector<int> &materials) const {
+    using LSPtr = SmartPointer<viennals::Domain<NumericType, D>>;
+
+    auto materialMap = domain->getMaterialMap();
+    if (!materialMap || materials.empty())
+      return nullptr;
+
+    auto &levelSets = domain->getLevelSets();
+    LSPtr result = nullptr;
+    for (std::size_t i = 0; i < levelSets.size(); ++i) {
+      const auto material = static_cast<int>(materialMap->getMaterialAtIdx(i));
+      if (std::find(materials.begin(), materials.end(), material) ==
+          materials.end())
+        continue;
+
+      auto layer = LSPtr::New(levelSets[i]);
+      if (i > 0) {
+        viennals::BooleanOperation<NumericType, D>(
+            layer, levelSets[i - 1],
+            viennals::BooleanOperationEnum::RELATIVE_COMPLEMENT)
+            .apply();
+      }
+      if (result) {
+        viennals::BooleanOperation<NumericType, D>(
+            result, layer, viennals::BooleanOperationEnum::UNION)
+            .apply();
+      } else {
+        result = layer;
+      }
+    }
+    return result;
+  }
 };
 
 } // namespace viennaps
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace viennaps {
+
+namespace utils {
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped,
+// otherwise it is read into memory with a single bulk read.
+class MappedFile {
+  const unsigned char *data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<unsigned char> buffer_;
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { close(); }
+
+  bool open(const std::string &fileName) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+      void *ptr = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size),
+                       PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr != MAP_FAILED) {
+        data_ = static_cast<const unsigned char *>(ptr);
+        size_ = static_cast<std::size_t>(fileStat.st_size);
+        mapped_ = true;
+        madvise(ptr, size_, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd);
+    if (mapped_)
+      return true;
+#endif
+    // fallback: read the whole file at once
+    FILE *filePtr = fopen(fileName.c_str(), "rb");
+    if (!filePtr)
+      return false;
+    fseek(filePtr, 0, SEEK_END);
+    const long fileSize = ftell(filePtr);
+    fseek(filePtr, 0, SEEK_SET);
+    buffer_.resize(fileSize > 0 ? static_cast<std::size_t>(fileSize) : 0);
+    size_ = fread(buffer_.data(), 1, buffer_.size(), filePtr);
+    fclose(filePtr);
+    data_ = buffer_.data();
+    return true;
+  }
+
+  void close() {
+#ifndef _WIN32
+    if (mapped_)
+      munmap(const_cast<unsigned char *>(data_), size_);
+#endif
+    mapped_ = false;
+    data_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+  }
+
+  const unsigned char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+};
+
+} // namespace utils
+} // namespace viennaps
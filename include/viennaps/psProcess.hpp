@@ -1,6 +1,7 @@
 #pragma once
 
 #include "psProcessModel.hpp"
+#include "psSurrogateFlux.hpp"
 #include "psTranslationField.hpp"
 #include "psUtils.hpp"
 
@@ -17,6 +18,32 @@ namespace viennaps {
 
 using namespace viennacore;
 
+// Timings (in seconds) and sizes of a single time step of a process.
+struct ProcessStepStatistics {
+  // Process time at the start of the step and length of the step
+  double processTime = 0.;
+  double timeStep = 0.;
+  std::size_t numSurfacePoints = 0;
+  std::size_t numLevelSetPoints = 0;
+  // Number of rays traced per particle type, including reflections
+  std::vector<std::size_t> raysTraced;
+  double diskMeshTime = 0.;
+  // Tracing time per particle type
+  std::vector<double> tracingTimes;
+  // Total flux calculation, including tracing and the surrogate
+  double fluxTime = 0.;
+  double surfaceModelTime = 0.;
+  double advectionTime = 0.;
+  double callbackTime = 0.;
+};
+
+// Statistics of the recently run process.
+struct ProcessStatistics {
+  double totalTime = 0.;
+  double coverageInitTime = 0.;
+  std::vector<ProcessStepStatistics> steps;
+};
+
 /// This class server as the main process tool, applying a user- or pre-defined
 /// process model to a domain. Depending on the user inputs surface advection, a
 /// single callback function or a geometric advection is applied.
@@ -60,6 +87,9 @@ public:
   // time step according to the CFL condition.
   NumericType getProcessDuration() const { return processTime; }
 
+  // Returns timings and sizes of the recently run process, per time step.
+  const ProcessStatistics &getStatistics() const { return statistics; }
+
   // Specify the number of rays to be traced for each particle throughout the
   // process. The total count of rays is the product of this number and the
   // number of points in the process geometry.
@@ -116,6 +146,14 @@ public:
   // are printed.
   void setPrintTimeInterval(NumericType passedTime) { printTime = passedTime; }
 
+  // Set a surrogate for the fluxes. In RECORD mode, the ray traced fluxes are
+  // recorded by the surrogate. In PREDICT mode, the fluxes are estimated by the
+  // surrogate and no rays are traced.
+  void setSurrogateFlux(
+      SmartPointer<SurrogateFlux<NumericType, D>> passedSurrogateFlux) {
+    surrogateFlux = passedSurrogateFlux;
+  }
+
   // A single flux calculation is performed on the domain surface. The result is
   // stored as point data on the nodes of the mesh.
   SmartPointer<viennals::Mesh<NumericType>> calculateFlux() const {
@@ -136,6 +174,22 @@ public:
       return mesh;
     }
 
+    if (surrogateFlux &&
+        surrogateFlux->getMode() == SurrogateFluxMode::PREDICT) {
+      auto rates = SmartPointer<viennals::PointData<NumericType>>::New();
+      if (!surrogateFlux->calculateRates(mesh->getNodes(), rates)) {
+        Logger::getInstance()
+            .addWarning("Surrogate flux rates could not be calculated.")
+            .print();
+        return mesh;
+      }
+      for (size_t idx = 0; idx < rates->getScalarDataSize(); idx++)
+        mesh->getCellData().insertNextScalarData(
+            std::move(*rates->getScalarData(idx)),
+            rates->getScalarDataLabel(idx));
+      return mesh;
+    }
+
     viennaray::BoundaryCondition rayBoundaryCondition[D];
     viennaray::Trace<NumericType, D> rayTracer;
 
@@ -210,6 +264,7 @@ public:
       return;
     }
     const auto name = model->getProcessName().value_or("default");
+    statistics = ProcessStatistics();
 
     if (!domain) {
       Logger::getInstance()
@@ -220,8 +275,10 @@ public:
 
     if (model->getGeometricModel()) {
       model->getGeometricModel()->setDomain(domain);
+      model->getGeometricModel()->setProcessDuration(processDuration);
       Logger::getInstance().addInfo("Applying geometric model...").print();
       model->getGeometricModel()->apply();
+      processTime = processDuration;
       return;
     }
 
@@ -283,7 +340,19 @@ public:
     }
 
     /* --------- Setup for ray tracing ----------- */
-    const bool useRayTracing = !model->getParticleTypes().empty();
+    const bool useSurrogateFlux =
+        surrogateFlux && surrogateFlux->getMode() == SurrogateFluxMode::PREDICT;
+    const bool useRayTracing =
+        !model->getParticleTypes().empty() && !useSurrogateFlux;
+    if (useSurrogateFlux) {
+      if (!surrogateFlux->initialize()) {
+        Logger::getInstance()
+            .addWarning("Surrogate flux could not be initialized.")
+            .print();
+        return;
+      }
+      Logger::getInstance().addInfo("Using surrogate fluxes.").print();
+    }
 
     viennaray::BoundaryCondition rayBoundaryCondition[D];
     viennaray::Trace<NumericType, D> rayTracer;
@@ -370,10 +439,7 @@ public:
           // We need additional signal handling when running the C++ code from
           // the
           // Python bindings to allow interrupts in the Python scripts
-#ifdef VIENNAPS_PYTHON_BUILD
-          if (PyErr_CheckSignals() != 0)
-            throw pybind11::error_already_set();
-#endif
+          utils::checkPythonSignals();
           // move coverages to the ray tracer
           viennaray::TracingData<NumericType> rayTraceCoverages =
               movePointDataToRayData(model->getSurfaceModel()->getCoverages());
@@ -394,34 +460,42 @@ public:
           auto rates = SmartPointer<viennals::PointData<NumericType>>::New();
 
           std::size_t particleIdx = 0;
-          for (auto &particle : model->getParticleTypes()) {
-            int dataLogSize = model->getParticleLogSize(particleIdx);
-            if (dataLogSize > 0) {
-              rayTracer.getDataLog().data.resize(1);
-              rayTracer.getDataLog().data[0].resize(dataLogSize, 0.);
-            }
-            rayTracer.setParticleType(particle);
-            rayTracer.apply();
-
-            // fill up rates vector with rates from this particle type
-            auto &localData = rayTracer.getLocalData();
-            int numRates = particle->getLocalDataLabels().size();
-            for (int i = 0; i < numRates; ++i) {
-              auto rate = std::move(localData.getVectorData(i));
-
-              // normalize fluxes
-              rayTracer.normalizeFlux(rate);
-              if (smoothFlux)
-                rayTracer.smoothFlux(rate);
-              rates->insertNextScalarData(std::move(rate),
-                                          localData.getVectorDataLabel(i));
-            }
-
-            if (dataLogSize > 0) {
-              particleDataLogs[particleIdx].merge(rayTracer.getDataLog());
-            }
-            ++particleIdx;
+          if (useSurrogateFlux &&
+              !surrogateFlux->calculateRates(points, rates)) {
+            Logger::getInstance()
+                .addWarning("Surrogate flux rates could not be calculated.")
+                .print();
+            return;
           }
+          if (!useSurrogateFlux)
+            for (auto &particle : model->getParticleTypes()) {
+              int dataLogSize = model->getParticleLogSize(particleIdx);
+              if (dataLogSize > 0) {
+                rayTracer.getDataLog().data.resize(1);
+                rayTracer.getDataLog().data[0].resize(dataLogSize, 0.);
+              }
+              rayTracer.setParticleType(particle);
+              rayTracer.apply();
+
+              // fill up rates vector with rates from this particle type
+              auto &localData = rayTracer.getLocalData();
+              int numRates = particle->getLocalDataLabels().size();
+              for (int i = 0; i < numRates; ++i) {
+                auto rate = std::move(localData.getVectorData(i));
+
+                // normalize fluxes
+                rayTracer.normalizeFlux(rate);
+                if (smoothFlux)
+                  rayTracer.smoothFlux(rate);
+                rates->insertNextScalarData(std::move(rate),
+                                            localData.getVectorDataLabel(i));
+              }
+
+              if (dataLogSize > 0) {
+                particleDataLogs[particleIdx].merge(rayTracer.getDataLog());
+              }
+              ++particleIdx;
+            }
 
           // move coverages back in the model
           moveRayDataToPointData(model->getSurfaceModel()->getCoverages(),
@@ -450,6 +524,7 @@ public:
         coveragesInitialized_ = true;
 
         timer.finish();
+        statistics.coverageInitTime = timer.currentDuration * 1e-9;
         Logger::getInstance()
             .addTiming("Coverage initialization", timer)
             .print();
@@ -461,18 +536,24 @@ public:
     Timer rtTimer;
     Timer callbackTimer;
     Timer advTimer;
+    Timer stepTimer;
     while (remainingTime > 0.) {
       // We need additional signal handling when running the C++ code from the
       // Python bindings to allow interrupts in the Python scripts
-#ifdef VIENNAPS_PYTHON_BUILD
-      if (PyErr_CheckSignals() != 0)
-        throw pybind11::error_already_set();
-#endif
+      utils::checkPythonSignals();
 
+      auto &step = statistics.steps.emplace_back();
+      step.processTime = processDuration - remainingTime;
       auto rates = SmartPointer<viennals::PointData<NumericType>>::New();
+      stepTimer.start();
       meshConverter.apply();
+      stepTimer.finish();
+      step.diskMeshTime = stepTimer.currentDuration * 1e-9;
       auto materialIds = *diskMesh->getCellData().getScalarData("MaterialIds");
       auto points = diskMesh->getNodes();
+      step.numSurfacePoints = points.size();
+      step.numLevelSetPoints =
+          domain->getLevelSets().back()->getNumberOfPoints();
 
       // rate calculation by top-down ray tracing
       if (useRayTracing) {
@@ -509,7 +590,12 @@ public:
             rayTracer.getDataLog().data[0].resize(dataLogSize, 0.);
           }
           rayTracer.setParticleType(particle);
+          stepTimer.start();
           rayTracer.apply();
+          stepTimer.finish();
+          step.tracingTimes.push_back(stepTimer.currentDuration * 1e-9);
+          step.raysTraced.push_back(
+              rayTracer.getRayTraceInfo().totalRaysTraced);
 
           // fill up rates vector with rates from this particle type
           auto numRates = particle->getLocalDataLabels().size();
@@ -535,16 +621,37 @@ public:
         if (useCoverages)
           moveRayDataToPointData(model->getSurfaceModel()->getCoverages(),
                                  rayTraceCoverages);
+
+        // store the traced fluxes as samples for the surrogate
+        if (surrogateFlux)
+          surrogateFlux->record(points, rates);
         rtTimer.finish();
+        step.fluxTime = rtTimer.currentDuration * 1e-9;
         Logger::getInstance()
             .addTiming("Top-down flux calculation", rtTimer)
             .print();
+      } else if (useSurrogateFlux) {
+        rtTimer.start();
+        if (!surrogateFlux->calculateRates(points, rates)) {
+          Logger::getInstance()
+              .addWarning("Surrogate flux rates could not be calculated.")
+              .print();
+          return;
+        }
+        rtTimer.finish();
+        step.fluxTime = rtTimer.currentDuration * 1e-9;
+        Logger::getInstance()
+            .addTiming("Surrogate flux calculation", rtTimer)
+            .print();
       }
 
       // get velocities from rates
+      stepTimer.start();
       auto velocities = model->getSurfaceModel()->calculateVelocities(
           rates, points, materialIds);
       model->getVelocityField()->setVelocities(velocities);
+      stepTimer.finish();
+      step.surfaceModelTime = stepTimer.currentDuration * 1e-9;
       if (model->getVelocityField()->getTranslationFieldOptions() == 2)
         transField->buildKdTree(points);
 
@@ -584,6 +691,7 @@ public:
         bool continueProcess = model->getAdvectionCallback()->applyPreAdvect(
             processDuration - remainingTime);
         callbackTimer.finish();
+        step.callbackTime += callbackTimer.currentDuration * 1e-9;
         Logger::getInstance()
             .addTiming("Advection callback pre-advect", callbackTimer)
             .print();
@@ -609,10 +717,14 @@ public:
       advTimer.start();
       advectionKernel.apply();
       advTimer.finish();
+      step.advectionTime = advTimer.currentDuration * 1e-9;
       Logger::getInstance().addTiming("Surface advection", advTimer).print();
 
       // update the translator to retrieve the correct coverages from the LS
+      stepTimer.start();
       meshConverter.apply();
+      stepTimer.finish();
+      step.diskMeshTime += stepTimer.currentDuration * 1e-9;
       if (useCoverages)
         updateCoveragesFromAdvectedSurface(
             translator, model->getSurfaceModel()->getCoverages());
@@ -623,6 +735,7 @@ public:
         bool continueProcess = model->getAdvectionCallback()->applyPostAdvect(
             advectionKernel.getAdvectedTime());
         callbackTimer.finish();
+        step.callbackTime += callbackTimer.currentDuration * 1e-9;
         Logger::getInstance()
             .addTiming("Advection callback post-advect", callbackTimer)
             .print();
@@ -645,6 +758,7 @@ public:
         break;
       }
       remainingTime -= previousTimeStep;
+      step.timeStep = previousTimeStep;
 
       if (Logger::getLogLevel() >= 2) {
         std::stringstream stream;
@@ -657,6 +771,7 @@ public:
 
     processTime = processDuration - remainingTime;
     processTimer.finish();
+    statistics.totalTime = processTimer.currentDuration * 1e-9;
 
     Logger::getInstance()
         .addTiming("\nProcess " + name, processTimer)
@@ -664,7 +779,7 @@ public:
                    advTimer.totalDuration * 1e-9,
                    processTimer.totalDuration * 1e-9)
         .print();
-    if (useRayTracing) {
+    if (useRayTracing || useSurrogateFlux) {
       Logger::getInstance()
           .addTiming("Top-down flux calculation total time",
                      rtTimer.totalDuration * 1e-9,
@@ -764,7 +879,8 @@ private:
 
   psDomainType domain;
   SmartPointer<ProcessModel<NumericType, D>> model;
-  NumericType processDuration;
+  SmartPointer<SurrogateFlux<NumericType, D>> surrogateFlux = nullptr;
+  NumericType processDuration = 0.;
   viennaray::TraceDirection sourceDirection =
       D == 3 ? viennaray::TraceDirection::POS_Z
              : viennaray::TraceDirection::POS_Y;
@@ -780,6 +896,7 @@ private:
   bool coveragesInitialized_ = false;
   NumericType printTime = 0.;
   NumericType processTime = 0.;
+  ProcessStatistics statistics;
   NumericType timeStepRatio = 0.4999;
 };
 
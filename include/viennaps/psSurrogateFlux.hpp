@@ -0,0 +1,246 @@
+#pragma once
+
+#include "compact/psDataSource.hpp"
+#include "compact/psNearestNeighborsInterpolation.hpp"
+
+#include <lsPointData.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vcLogger.hpp>
+#include <vcSmartPointer.hpp>
+
+namespace viennaps {
+
+using namespace viennacore;
+
+enum class SurrogateFluxMode : unsigned {
+  // Fluxes are ray traced and recorded as samples for the surrogate
+  RECORD = 0,
+  // Fluxes are estimated from the recorded samples without ray tracing
+  PREDICT = 1
+};
+
+/// Surrogate for feature-scale fluxes. Every surface point is described by the
+/// aspect ratio of the feature, its relative depth within the feature, and the
+/// sticking probability and source power of the particle. In RECORD mode, the
+/// normalized fluxes from ray tracing are stored as samples of these features.
+/// In PREDICT mode, the fluxes are estimated from the samples, by default using
+/// nearest neighbors interpolation. The surrogate does not take coverages into
+/// account.
+template <typename NumericType, int D> class SurrogateFlux {
+public:
+  using ItemType = std::vector<NumericType>;
+  using VectorType = std::vector<ItemType>;
+  using ConstPtr = SmartPointer<const VectorType>;
+
+  // aspect ratio, relative depth, sticking probability, source power
+  static constexpr int numFeatures = 4;
+
+private:
+  struct FluxParameters {
+    std::string label;
+    NumericType stickingProbability;
+    NumericType sourcePower;
+  };
+
+  std::vector<FluxParameters> fluxes;
+  SurrogateFluxMode mode = SurrogateFluxMode::RECORD;
+  NumericType featureWidth = 1.;
+  unsigned recordStride = 1;
+
+  VectorType samples;
+  SmartPointer<DataSource<NumericType>> dataSource = nullptr;
+
+  std::function<bool(ConstPtr)> initializeEstimator;
+  std::function<bool(const NumericType *, std::size_t, NumericType *)>
+      estimateBatch;
+  bool estimatorInitialized = false;
+
+  // Aspect ratio of the feature and relative depth of each point
+  std::pair<NumericType, std::vector<NumericType>>
+  computeFeatures(const std::vector<std::array<NumericType, 3>> &points) const {
+    NumericType top = std::numeric_limits<NumericType>::lowest();
+    NumericType bottom = std::numeric_limits<NumericType>::max();
+    for (const auto &p : points) {
+      top = std::max(top, p[D - 1]);
+      bottom = std::min(bottom, p[D - 1]);
+    }
+    const NumericType depth = points.empty() ? 0. : top - bottom;
+
+    std::vector<NumericType> relativeDepth(points.size(), 0.);
+    if (depth > 0)
+      for (std::size_t i = 0; i < points.size(); ++i)
+        relativeDepth[i] = (top - points[i][D - 1]) / depth;
+
+    return {depth / featureWidth, std::move(relativeDepth)};
+  }
+
+public:
+  SurrogateFlux() { setEstimator(defaultEstimator()); }
+
+  SurrogateFlux(NumericType passedFeatureWidth)
+      : featureWidth(passedFeatureWidth) {
+    setEstimator(defaultEstimator());
+  }
+
+  static auto defaultEstimator() {
+    auto estimator =
+        SmartPointer<NearestNeighborsInterpolation<NumericType>>::New();
+    estimator->setNumberOfNeighbors(5);
+    return estimator;
+  }
+
+  // Width of the trench or diameter of the hole, used to compute the aspect
+  // ratio from the current feature depth.
+  void setFeatureWidth(NumericType passedFeatureWidth) {
+    featureWidth = passedFeatureWidth;
+  }
+
+  // Register a flux, identified by its label in the rates of the ray tracer.
+  void addFlux(const std::string &label, NumericType stickingProbability,
+               NumericType sourcePower = 1.) {
+    fluxes.push_back({label, stickingProbability, sourcePower});
+  }
+
+  void setMode(SurrogateFluxMode passedMode) { mode = passedMode; }
+
+  SurrogateFluxMode getMode() const { return mode; }
+
+  // Only record every n-th surface point.
+  void setRecordStride(unsigned stride) { recordStride = std::max(1u, stride); }
+
+  // Set the data source holding the samples. Samples already stored in the
+  // data source are used for prediction, new samples are added to it.
+  void setDataSource(SmartPointer<DataSource<NumericType>> passedDataSource) {
+    dataSource = passedDataSource;
+    samples.clear();
+    if (dataSource) {
+      if (auto data = dataSource->getData())
+        samples = *data;
+    }
+    estimatorInitialized = false;
+  }
+
+  // Write the recorded samples to the data source.
+  bool save() {
+    if (!dataSource) {
+      Logger::getInstance()
+          .addWarning("SurrogateFlux: No data source to save samples to.")
+          .print();
+      return false;
+    }
+    return dataSource->sync();
+  }
+
+  // Set the estimator used for prediction. It has to provide the
+  // ValueEstimator interface.
+  template <class Estimator> void setEstimator(SmartPointer<Estimator> est) {
+    initializeEstimator = [est](ConstPtr data) {
+      est->setDataDimensions(numFeatures, 1);
+      est->setData(data);
+      return est->initialize();
+    };
+    estimateBatch = [est](const NumericType *inputs, std::size_t numInputs,
+                          NumericType *outputs) {
+      return est->estimateBatch(inputs, numInputs, outputs);
+    };
+    estimatorInitialized = false;
+  }
+
+  // Initialize the estimator with the recorded samples. This is done
+  // automatically before the first prediction.
+  bool initialize() {
+    if (estimatorInitialized)
+      return true;
+    if (samples.empty()) {
+      Logger::getInstance()
+          .addWarning("SurrogateFlux: No samples recorded.")
+          .print();
+      return false;
+    }
+    estimatorInitialized = initializeEstimator(ConstPtr::New(samples));
+    return estimatorInitialized;
+  }
+
+  const VectorType &getSamples() const { return samples; }
+
+  std::size_t getNumberOfSamples() const { return samples.size(); }
+
+  // Store the ray traced fluxes of all registered labels as samples.
+  void record(const std::vector<std::array<NumericType, 3>> &points,
+              SmartPointer<viennals::PointData<NumericType>> rates) {
+    const auto features = computeFeatures(points);
+    const NumericType aspectRatio = features.first;
+    const auto &relativeDepth = features.second;
+
+    for (const auto &flux : fluxes) {
+      auto rate = rates->getScalarData(flux.label, true);
+      if (!rate || rate->size() != points.size()) {
+        Logger::getInstance()
+            .addWarning("SurrogateFlux: No flux '" + flux.label +
+                        "' to record.")
+            .print();
+        continue;
+      }
+      for (std::size_t i = 0; i < points.size(); i += recordStride) {
+        ItemType sample{aspectRatio, relativeDepth[i],
+                        flux.stickingProbability, flux.sourcePower,
+                        rate->at(i)};
+        if (dataSource)
+          dataSource->add(sample);
+        samples.push_back(std::move(sample));
+      }
+    }
+    estimatorInitialized = false;
+  }
+
+  // Estimate the fluxes of all registered labels at the given points and
+  // insert them into the rates.
+  bool calculateRates(const std::vector<std::array<NumericType, 3>> &points,
+                      SmartPointer<viennals::PointData<NumericType>> rates) {
+    if (!initialize())
+      return false;
+
+    const auto features = computeFeatures(points);
+    const NumericType aspectRatio = features.first;
+    const auto &relativeDepth = features.second;
+    const std::size_t numPoints = points.size();
+    std::vector<NumericType> inputs(numPoints * numFeatures);
+
+    for (const auto &flux : fluxes) {
+#pragma omp parallel for
+      for (long i = 0; i < static_cast<long>(numPoints); ++i) {
+        auto input = &inputs[i * numFeatures];
+        input[0] = aspectRatio;
+        input[1] = relativeDepth[i];
+        input[2] = flux.stickingProbability;
+        input[3] = flux.sourcePower;
+      }
+
+      std::vector<NumericType> rate(numPoints);
+      if (!estimateBatch(inputs.data(), numPoints, rate.data())) {
+        Logger::getInstance()
+            .addWarning("SurrogateFlux: Flux '" + flux.label +
+                        "' could not be estimated.")
+            .print();
+        return false;
+      }
+      // fluxes are non-negative, NaN is kept to not hide a broken estimate
+      for (auto &r : rate)
+        if (r < 0)
+          r = 0.;
+
+      rates->insertNextScalarData(std::move(rate), flux.label);
+    }
+    return true;
+  }
+};
+
+} // namespace viennaps
@@ -13,6 +13,10 @@
 #include <type_traits>
 #include <unordered_map>
 
+#ifdef VIENNAPS_PYTHON_BUILD
+#include <pybind11/pybind11.h>
+#endif
+
 namespace viennaps {
 
 namespace utils {
@@ -27,6 +31,17 @@ namespace utils {
   return false;
 }
 
+// Checks for pending signals (e.g. KeyboardInterrupt) when running from the
+// Python bindings, so that long simulations can be interrupted. The bindings
+// release the GIL while a simulation runs, so it is re-acquired for the check.
+inline void checkPythonSignals() {
+#ifdef VIENNAPS_PYTHON_BUILD
+  pybind11::gil_scoped_acquire gil;
+  if (PyErr_CheckSignals() != 0)
+    throw pybind11::error_already_set();
+#endif
+}
+
 // Converts string to the given numeric datatype
 template <typename T> [[nodiscard]] T convert(const std::string &s) {
   if constexpr (std::is_same_v<T, int>) {
@@ -13,6 +13,7 @@
 #define STRINGIZE(s) STRINGIZE2(s)
 #define VIENNAPS_MODULE_VERSION STRINGIZE(VIENNAPS_VERSION)
 
+#include <cstring>
 #include <optional>
 #include <vector>
 
@@ -81,6 +82,10 @@ typedef SmartPointer<Domain<T, D>> DomainType;
 
 PYBIND11_DECLARE_HOLDER_TYPE(Types, SmartPointer<Types>)
 
+// Call guard releasing the GIL during long-running C++ calls. Python callbacks
+// and signal checks re-acquire it when needed.
+using ReleaseGIL = pybind11::call_guard<pybind11::gil_scoped_release>;
+
 // NOTES:
 // PYBIND11_MAKE_OPAQUE(std::vector<T, std::allocator<T>>) can not be used
 // constructors with custom enum need lambda to work: seems to be an issue
@@ -89,35 +94,6 @@ PYBIND11_DECLARE_HOLDER_TYPE(Types, SmartPointer<Types>)
 // define trampoline classes for interface functions
 // ALSO NEED TO ADD TRAMPOLINE CLASSES FOR CLASSES
 // WHICH HOLD REFERENCES TO INTERFACE(ABSTRACT) CLASSES
-// class PypsSurfaceModel : public SurfaceModel<T> {
-//   using SurfaceModel<T>::coverages;
-//   using SurfaceModel<T>::processParams;
-//   using SurfaceModel<T>::getCoverages;
-//   using SurfaceModel<T>::getProcessParameters;
-//   typedef std::vector<T> vect_type;
-// public:
-//   void initializeCoverages(unsigned numGeometryPoints) override {
-//     PYBIND11_OVERRIDE(void, SurfaceModel<T>, initializeCoverages,
-//                       numGeometryPoints);
-//   }
-//   void initializeProcessParameters() override {
-//     PYBIND11_OVERRIDE(void, SurfaceModel<T>, initializeProcessParameters,
-//     );
-//   }
-//   SmartPointer<std::vector<T>>
-//   calculateVelocities(SmartPointer<psPointData<T>> rates,
-//                       const std::vector<std::array<T, 3>> &coordinates,
-//                       const std::vector<T> &materialIds) override {
-//     PYBIND11_OVERRIDE(SmartPointer<std::vector<T>>, SurfaceModel<T>,
-//                       calculateVelocities, rates, coordinates, materialIds);
-//   }
-//   void updateCoverages(SmartPointer<psPointData<T>> rates,
-//                        const std::vector<T> &materialIds) override {
-//     PYBIND11_OVERRIDE(void, SurfaceModel<T>, updateCoverages, rates,
-//                       materialIds);
-//   }
-// };
-
 // AdvectionCallback
 class PyAdvectionCallback : public AdvectionCallback<T, D> {
 protected:
@@ -246,48 +222,6 @@ public:
 //   const T cosineExponent = 1.;
 //   const std::string dataLabel = "flux";
 // };
-// VelocityField
-// class PyVelocityField : public VelocityField<T> {
-//   using VelocityField<T>::psVelocityField;
-// public:
-//   T getScalarVelocity(const std::array<T, 3> &coordinate, int material,
-//                       const std::array<T, 3> &normalVector,
-//                       unsigned long pointId) override {
-//     PYBIND11_OVERRIDE(T, VelocityField<T>, getScalarVelocity, coordinate,
-//                       material, normalVector, pointId);
-//   }
-//   // if we declare a typedef for std::array<T,3>, we will no longer get this
-//   // error: the compiler doesn't understand why std::array gets 2 template
-//   // arguments
-//   // add template argument as the preprocessor becomes confused with the
-//   comma
-//   // in std::array<T, 3>
-//   typedef std::array<T, 3> arrayType;
-//   std::array<T, 3> getVectorVelocity(const std::array<T, 3> &coordinate,
-//                                      int material,
-//                                      const std::array<T, 3> &normalVector,
-//                                      unsigned long pointId) override {
-//     PYBIND11_OVERRIDE(
-//         arrayType, // add template argument here, as the preprocessor becomes
-//                    // confused with the comma in std::array<T, 3>
-//         VelocityField<T>, getVectorVelocity, coordinate, material,
-//         normalVector, pointId);
-//   }
-//   T getDissipationAlpha(int direction, int material,
-//                         const std::array<T, 3> &centralDifferences) override
-//                         {
-//     PYBIND11_OVERRIDE(T, VelocityField<T>, getDissipationAlpha, direction,
-//                       material, centralDifferences);
-//   }
-//   void setVelocities(SmartPointer<std::vector<T>> passedVelocities)
-//   override {
-//     PYBIND11_OVERRIDE(void, VelocityField<T>, setVelocities,
-//                       passedVelocities);
-//   }
-//   int getTranslationFieldOptions() const override {
-//     PYBIND11_OVERRIDE(int, VelocityField<T>, getTranslationFieldOptions, );
-//   }
-// };
 // a function to declare GeometricDistributionModel of type DistType
 // template <typename NumericType, int D, typename DistType>
 // void declare_GeometricDistributionModel(pybind11::module &m,
@@ -301,6 +235,226 @@ public:
 //       .def("apply", &Class::apply);
 // }
 
+// Wraps memory owned by a smart pointer into a numpy array without copying.
+// The array holds a reference to the owner, which keeps the data alive as long
+// as the array is in use. The array must not be used after the underlying
+// vector has been resized, e.g. by regenerating the mesh.
+template <class Owner>
+pybind11::array_t<T> makeArrayView(T *data,
+                                   std::vector<pybind11::ssize_t> shape,
+                                   SmartPointer<Owner> owner) {
+  auto holder = new SmartPointer<Owner>(std::move(owner));
+  pybind11::capsule base(holder, [](void *ptr) {
+    delete static_cast<SmartPointer<Owner> *>(ptr);
+  });
+  return pybind11::array_t<T>(std::move(shape), data, base);
+}
+
+viennals::PointData<T> &getMeshData(viennals::Mesh<T> &mesh, bool pointData) {
+  return pointData ? mesh.getPointData() : mesh.getCellData();
+}
+
+// Copies a list of coordinates into a numpy array of shape (N, 3).
+pybind11::array_t<T> toArray(const std::vector<Vec3D<T>> &coordinates) {
+  return pybind11::array_t<T>(
+      {static_cast<pybind11::ssize_t>(coordinates.size()),
+       pybind11::ssize_t(3)},
+      reinterpret_cast<const T *>(coordinates.data()));
+}
+
+pybind11::array_t<T> toArray(const std::vector<T> &values) {
+  return pybind11::array_t<T>(static_cast<pybind11::ssize_t>(values.size()),
+                              values.data());
+}
+
+// Wraps all scalar data of the point data into a dictionary of numpy views,
+// using the data labels as keys.
+pybind11::dict toDict(SmartPointer<viennals::PointData<T>> pointData) {
+  pybind11::dict dict;
+  if (!pointData)
+    return dict;
+  for (int i = 0; i < static_cast<int>(pointData->getScalarDataSize()); ++i) {
+    auto data = pointData->getScalarData(i);
+    dict[pybind11::str(pointData->getScalarDataLabel(i))] = makeArrayView(
+        data->data(), {static_cast<pybind11::ssize_t>(data->size())},
+        pointData);
+  }
+  return dict;
+}
+
+// Converts an array returned from Python into a vector of the expected size.
+SmartPointer<std::vector<T>> toVector(const pybind11::object &object,
+                                      std::size_t size,
+                                      const std::string &function) {
+  auto array = object.cast<
+      pybind11::array_t<T, pybind11::array::c_style |
+                               pybind11::array::forcecast>>();
+  if (array.ndim() != 1 || static_cast<std::size_t>(array.size()) != size)
+    throw pybind11::value_error(function + ": expected an array of " +
+                                std::to_string(size) + " values.");
+  return SmartPointer<std::vector<T>>::New(array.data(),
+                                           array.data() + array.size());
+}
+
+// SurfaceModel
+// The overridable methods work on the whole surface at once: rates,
+// coverages, coordinates and material IDs are passed as numpy arrays, so a
+// model written in Python only needs to acquire the GIL once per call and can
+// be vectorized with numpy. The rate and coverage arrays are views into the
+// simulation data and are only valid during the call.
+class PySurfaceModel : public SurfaceModel<T> {
+  using ClassName = SurfaceModel<T>;
+
+public:
+  void initializeCoverages(unsigned numGeometryPoints) override {
+    PYBIND11_OVERRIDE(void, ClassName, initializeCoverages, numGeometryPoints);
+  }
+
+  void initializeProcessParameters() override {
+    PYBIND11_OVERRIDE(void, ClassName, initializeProcessParameters, );
+  }
+
+  SmartPointer<std::vector<T>>
+  calculateVelocities(SmartPointer<viennals::PointData<T>> rates,
+                      const std::vector<Vec3D<T>> &coordinates,
+                      const std::vector<T> &materialIds) override {
+    pybind11::gil_scoped_acquire gil;
+    auto override = pybind11::get_override(this, "calculateVelocities");
+    if (!override)
+      return ClassName::calculateVelocities(rates, coordinates, materialIds);
+
+    auto result =
+        override(toDict(rates), toArray(coordinates), toArray(materialIds));
+    if (result.is_none())
+      return nullptr;
+    return toVector(result, coordinates.size(), "calculateVelocities");
+  }
+
+  void updateCoverages(SmartPointer<viennals::PointData<T>> rates,
+                       const std::vector<T> &materialIds) override {
+    pybind11::gil_scoped_acquire gil;
+    auto override = pybind11::get_override(this, "updateCoverages");
+    if (!override)
+      return ClassName::updateCoverages(rates, materialIds);
+
+    override(toDict(rates), toArray(materialIds));
+  }
+
+  // Inserts or replaces the coverage with the given label.
+  void setCoverage(const std::string &label, std::vector<T> values) {
+    if (!coverages)
+      coverages = SmartPointer<viennals::PointData<T>>::New();
+    if (auto data = coverages->getScalarData(label, true))
+      *data = std::move(values);
+    else
+      coverages->insertNextScalarData(std::move(values), label);
+  }
+
+  void setProcessParameters(SmartPointer<ProcessParams<T>> params) {
+    processParams = params;
+  }
+};
+
+PySurfaceModel &toPySurfaceModel(SurfaceModel<T> &model) {
+  auto pyModel = dynamic_cast<PySurfaceModel *>(&model);
+  if (!pyModel)
+    throw pybind11::type_error(
+        "Only surface models implemented in Python can be modified.");
+  return *pyModel;
+}
+
+// Calls the Python override of setVelocities, if there is one, with a
+// writable view of the velocities of all surface points. The override can
+// modify the velocities in place and return None, or return new velocities.
+template <class Class>
+pybind11::object
+callSetVelocities(const Class *velocityField,
+                  const SmartPointer<std::vector<T>> &velocities) {
+  auto override = pybind11::get_override(velocityField, "setVelocities");
+  if (!override)
+    return pybind11::none();
+  if (!velocities)
+    return override(pybind11::none());
+  return override(makeArrayView(
+      velocities->data(), {static_cast<pybind11::ssize_t>(velocities->size())},
+      velocities));
+}
+
+// VelocityField
+// Advection queries the velocity of every level set point separately, which is
+// too fine-grained for calls into Python. Instead, setVelocities() is
+// overridable and receives the velocities of the whole surface once per time
+// step. Returning an array of shape (N, 3) sets vector velocities, which then
+// replace the scalar velocities.
+class PyVelocityField : public VelocityField<T> {
+  using ClassName = VelocityField<T>;
+
+  SmartPointer<std::vector<T>> scalarVelocities;
+  std::vector<Vec3D<T>> vectorVelocities;
+
+public:
+  T getScalarVelocity(const Vec3D<T> &, int, const Vec3D<T> &,
+                      unsigned long pointId) override {
+    if (scalarVelocities && pointId < scalarVelocities->size())
+      return (*scalarVelocities)[pointId];
+    return 0.;
+  }
+
+  Vec3D<T> getVectorVelocity(const Vec3D<T> &, int, const Vec3D<T> &,
+                             unsigned long pointId) override {
+    if (pointId < vectorVelocities.size())
+      return vectorVelocities[pointId];
+    return {0., 0., 0.};
+  }
+
+  void setVelocities(SmartPointer<std::vector<T>> velocities) override {
+    scalarVelocities = velocities;
+    vectorVelocities.clear();
+
+    pybind11::gil_scoped_acquire gil;
+    auto result = callSetVelocities(this, velocities);
+    if (result.is_none())
+      return;
+
+    const std::size_t size = velocities ? velocities->size() : 0;
+    auto array = result.cast<
+        pybind11::array_t<T, pybind11::array::c_style |
+                                 pybind11::array::forcecast>>();
+    if (array.ndim() == 2 && array.shape(1) == 3 &&
+        static_cast<std::size_t>(array.shape(0)) == size) {
+      vectorVelocities.resize(size);
+      std::memcpy(vectorVelocities.data(), array.data(),
+                  size * sizeof(Vec3D<T>));
+      scalarVelocities = nullptr;
+    } else {
+      scalarVelocities = toVector(result, size, "setVelocities");
+    }
+  }
+
+  int getTranslationFieldOptions() const override {
+    PYBIND11_OVERRIDE(int, ClassName, getTranslationFieldOptions, );
+  }
+};
+
+// DefaultVelocityField
+class PyDefaultVelocityField : public DefaultVelocityField<T> {
+  using ClassName = DefaultVelocityField<T>;
+
+public:
+  using DefaultVelocityField<T>::DefaultVelocityField;
+
+  void setVelocities(SmartPointer<std::vector<T>> velocities) override {
+    {
+      pybind11::gil_scoped_acquire gil;
+      auto result = callSetVelocities(this, velocities);
+      if (!result.is_none())
+        velocities = toVector(result, velocities ? velocities->size() : 0,
+                              "setVelocities");
+    }
+    ClassName::setVelocities(velocities);
+  }
+};
+
 PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
   module.doc() =
       "ViennaPS is a header-only C++ process simulation library which "
@@ -384,10 +538,13 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
              // Return the new vector of shared_ptr
              return shared_ptrs;
            })
-      .def("setSurfaceModel",
-           [](ProcessModel<T, D> &pm, SmartPointer<SurfaceModel<T>> &sm) {
-             pm.setSurfaceModel(sm);
-           })
+      // keep the Python part of models derived in Python alive
+      .def(
+          "setSurfaceModel",
+          [](ProcessModel<T, D> &pm, SmartPointer<SurfaceModel<T>> &sm) {
+            pm.setSurfaceModel(sm);
+          },
+          pybind11::keep_alive<1, 2>())
       .def("setAdvectionCallback",
            [](ProcessModel<T, D> &pm,
               SmartPointer<AdvectionCallback<T, D>> &ac) {
@@ -408,10 +565,12 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
            [](ProcessModel<T, D> &pm, SmartPointer<GeometricModel<T, D>> &gm) {
              pm.setGeometricModel(gm);
            })
-      .def("setVelocityField",
-           [](ProcessModel<T, D> &pm, SmartPointer<VelocityField<T>> &vf) {
-             pm.setVelocityField(vf);
-           })
+      .def(
+          "setVelocityField",
+          [](ProcessModel<T, D> &pm, SmartPointer<VelocityField<T>> &vf) {
+            pm.setVelocityField(vf);
+          },
+          pybind11::keep_alive<1, 2>())
       .def("setPrimaryDirection", &ProcessModel<T, D>::setPrimaryDirection)
       .def("getPrimaryDirection", &ProcessModel<T, D>::getPrimaryDirection);
 
@@ -446,46 +605,90 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def("getScalarDataLabel", &ProcessParams<T>::getScalarDataLabel);
 
   // SurfaceModel
-  //   pybind11::class_<SurfaceModel<T>, SmartPointer<SurfaceModel<T>>,
-  //                    PypsSurfaceModel>(module, "SurfaceModel")
-  //       .def(pybind11::init<>())
-  //       .def("initializeCoverages", &SurfaceModel<T>::initializeCoverages)
-  //       .def("initializeProcessParameters",
-  //            &SurfaceModel<T>::initializeProcessParameters)
-  //       .def("getCoverages", &SurfaceModel<T>::getCoverages)
-  //       .def("getProcessParameters",
-  //       &SurfaceModel<T>::getProcessParameters) .def("calculateVelocities",
-  //       &SurfaceModel<T>::calculateVelocities) .def("updateCoverages",
-  //       &SurfaceModel<T>::updateCoverages);
+  pybind11::class_<SurfaceModel<T>, SmartPointer<SurfaceModel<T>>,
+                   PySurfaceModel>(module, "SurfaceModel")
+      // constructors
+      .def(pybind11::init<>())
+      // methods
+      .def("initializeCoverages", &SurfaceModel<T>::initializeCoverages,
+           pybind11::arg("numGeometryPoints"),
+           "Initialize the coverages of all surface points.")
+      .def("initializeProcessParameters",
+           &SurfaceModel<T>::initializeProcessParameters)
+      .def(
+          "calculateVelocities",
+          [](SurfaceModel<T> &, pybind11::dict, pybind11::array_t<T>,
+             pybind11::array_t<T>) -> pybind11::object {
+            return pybind11::none();
+          },
+          pybind11::arg("rates"), pybind11::arg("coordinates"),
+          pybind11::arg("materialIds"),
+          "Calculate the velocities of all surface points from the rates "
+          "(dict of arrays), coordinates (N x 3) and material IDs (N). "
+          "Returns an array of N velocities.")
+      .def(
+          "updateCoverages",
+          [](SurfaceModel<T> &, pybind11::dict, pybind11::array_t<T>) {},
+          pybind11::arg("rates"), pybind11::arg("materialIds"),
+          "Update the coverages from the rates (dict of arrays) and material "
+          "IDs (N).")
+      .def(
+          "getCoverages",
+          [](SurfaceModel<T> &model) { return toDict(model.getCoverages()); },
+          "Get the coverages as a dict of arrays. The arrays are views into "
+          "the coverages and can be modified in place.")
+      .def(
+          "setCoverage",
+          [](SurfaceModel<T> &model, const std::string &label,
+             std::vector<T> values) {
+            toPySurfaceModel(model).setCoverage(label, std::move(values));
+          },
+          pybind11::arg("label"), pybind11::arg("values"),
+          "Insert or replace the coverage with the given label.")
+      .def("getProcessParameters", &SurfaceModel<T>::getProcessParameters)
+      .def(
+          "setProcessParameters",
+          [](SurfaceModel<T> &model, SmartPointer<ProcessParams<T>> params) {
+            toPySurfaceModel(model).setProcessParameters(params);
+          },
+          pybind11::arg("params"));
+
   // VelocityField
-  //   pybind11::class_<VelocityField<T>, SmartPointer<VelocityField<T>>,
-  //                    PyVelocityField>
-  //       velocityField(module, "VelocityField");
-  //   // constructors
-  //   velocityField
-  //       .def(pybind11::init<>())
-  //       // methods
-  //       .def("getScalarVelocity", &VelocityField<T>::getScalarVelocity)
-  //       .def("getVectorVelocity", &VelocityField<T>::getVectorVelocity)
-  //       .def("getDissipationAlpha", &VelocityField<T>::getDissipationAlpha)
-  //       .def("getTranslationFieldOptions",
-  //            &VelocityField<T>::getTranslationFieldOptions)
-  //       .def("setVelocities", &VelocityField<T>::setVelocities);
-  //   pybind11::class_<psDefaultVelocityField<T>,
-  //                    SmartPointer<psDefaultVelocityField<T>>>(
-  //       module, "DefaultVelocityField", velocityField)
-  //       // constructors
-  //       .def(pybind11::init<>())
-  //       // methods
-  //       .def("getScalarVelocity",
-  //       &psDefaultVelocityField<T>::getScalarVelocity)
-  //       .def("getVectorVelocity",
-  //       &psDefaultVelocityField<T>::getVectorVelocity)
-  //       .def("getDissipationAlpha",
-  //            &psDefaultVelocityField<T>::getDissipationAlpha)
-  //       .def("getTranslationFieldOptions",
-  //            &psDefaultVelocityField<T>::getTranslationFieldOptions)
-  //       .def("setVelocities", &psDefaultVelocityField<T>::setVelocities);
+  pybind11::class_<VelocityField<T>, SmartPointer<VelocityField<T>>,
+                   PyVelocityField>
+      velocityField(module, "VelocityField");
+  // constructors
+  velocityField
+      .def(pybind11::init<>())
+      // methods
+      .def(
+          "setVelocities",
+          [](VelocityField<T> &, pybind11::object) -> pybind11::object {
+            return pybind11::none();
+          },
+          pybind11::arg("velocities"),
+          "Called once per time step with the velocities of all surface "
+          "points. The velocities can be modified in place, or new scalar (N) "
+          "or vector (N x 3) velocities can be returned.")
+      .def("getTranslationFieldOptions",
+           &VelocityField<T>::getTranslationFieldOptions);
+
+  pybind11::class_<DefaultVelocityField<T>,
+                   SmartPointer<DefaultVelocityField<T>>,
+                   PyDefaultVelocityField>(module, "DefaultVelocityField",
+                                           velocityField)
+      // constructors
+      .def(pybind11::init<int>(), pybind11::arg("translationFieldOptions") = 1)
+      // methods
+      .def(
+          "setVelocities",
+          [](DefaultVelocityField<T> &, pybind11::object) -> pybind11::object {
+            return pybind11::none();
+          },
+          pybind11::arg("velocities"),
+          "Called once per time step with the velocities of all surface "
+          "points. The velocities can be modified in place, or new velocities "
+          "can be returned.");
 
   // Shim to instantiate the particle class
   pybind11::class_<psParticle<D>, SmartPointer<psParticle<D>>> particle(
@@ -837,7 +1040,14 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def(pybind11::init([](const T rate, const std::vector<Material> mask) {
              return SmartPointer<IsotropicProcess<T, D>>::New(rate, mask);
            }),
-           pybind11::arg("rate"), pybind11::arg("maskMaterial"));
+           pybind11::arg("rate"), pybind11::arg("maskMaterial"))
+      .def("enableAnalyticOffset",
+           &IsotropicProcess<T, D>::enableAnalyticOffset,
+           "Compute the final surface in a single geometric offset instead of "
+           "advecting the surface in time steps.")
+      .def("disableAnalyticOffset",
+           &IsotropicProcess<T, D>::disableAnalyticOffset,
+           "Advect the surface in time steps (default).");
 
   // Directional Etching
   pybind11::class_<DirectionalEtching<T, D>,
@@ -852,7 +1062,15 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def(pybind11::init<const std::array<T, 3> &, const T, const T,
                           const std::vector<Material>>(),
            pybind11::arg("direction"), pybind11::arg("directionalVelocity"),
-           pybind11::arg("isotropicVelocity"), pybind11::arg("maskMaterial"));
+           pybind11::arg("isotropicVelocity"), pybind11::arg("maskMaterial"))
+      .def("enableGeometricSweep",
+           &DirectionalEtching<T, D>::enableGeometricSweep,
+           "Compute the etched surface in a single geometric sweep instead of "
+           "advecting the surface in time steps. Only possible for purely "
+           "directional etching.")
+      .def("disableGeometricSweep",
+           &DirectionalEtching<T, D>::disableGeometricSweep,
+           "Advect the surface in time steps (default).");
 
   // Sphere Distribution
   pybind11::class_<SphereDistribution<T, D>,
@@ -903,7 +1121,13 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
           pybind11::arg("diffusionCoefficient"), pybind11::arg("sinkStrength"),
           pybind11::arg("scallopVelocity"), pybind11::arg("centerVelocity"),
           pybind11::arg("topHeight"), pybind11::arg("centerWidth"),
-          pybind11::arg("stabilityFactor"));
+          pybind11::arg("stabilityFactor"))
+      .def("enableImplicitDiffusion",
+           &OxideRegrowth<T, D>::enableImplicitDiffusion,
+           "Solve the byproduct diffusion implicitly.")
+      .def("disableImplicitDiffusion",
+           &OxideRegrowth<T, D>::disableImplicitDiffusion,
+           "Solve the byproduct diffusion with explicit time steps.");
 
   // Anisotropic Process
   pybind11::class_<AnisotropicProcess<T, D>,
@@ -919,7 +1143,14 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
            pybind11::arg("direction100"), pybind11::arg("direction010"),
            pybind11::arg("rate100"), pybind11::arg("rate110"),
            pybind11::arg("rate111"), pybind11::arg("rate311"),
-           pybind11::arg("materials"));
+           pybind11::arg("materials"))
+      .def("enableLookupTable", &AnisotropicProcess<T, D>::enableLookupTable,
+           pybind11::arg("tolerance") = 1e-2,
+           "Evaluate the crystal orientation velocity from a precomputed "
+           "lookup table. The tolerance specifies the maximum deviation from "
+           "the analytic velocity relative to the largest rate.")
+      .def("disableLookupTable", &AnisotropicProcess<T, D>::disableLookupTable,
+           "Evaluate the analytic velocity for every point (default).");
 
   // Single Particle ALD
   pybind11::class_<SingleParticleALD<T, D>,
@@ -1037,7 +1268,8 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def(pybind11::init<DomainType, SmartPointer<ProcessModel<T, D>>>(),
            pybind11::arg("domain"), pybind11::arg("model"))
       // methods
-      .def("apply", &AtomicLayerProcess<T, D>::apply, "Run the process.")
+      .def("apply", &AtomicLayerProcess<T, D>::apply, ReleaseGIL(),
+           "Run the process.")
       .def("setDomain", &AtomicLayerProcess<T, D>::setDomain,
            "Set the process domain.")
       .def("setProcessModel", &AtomicLayerProcess<T, D>::setProcessModel,
@@ -1063,6 +1295,15 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
            "lsIntegrationSchemeEnum.")
       .def("setNumCycles", &AtomicLayerProcess<T, D>::setNumCycles,
            "Set the number of cycles for the process.")
+      .def("enableCycleExtrapolation",
+           &AtomicLayerProcess<T, D>::enableCycleExtrapolation,
+           pybind11::arg("driftTolerance") = 0.5,
+           "Reuse the traced surface velocities for subsequent cycles and "
+           "merge cycles into one advection step while the surface drift "
+           "stays below the tolerance (in units of grid delta).")
+      .def("disableCycleExtrapolation",
+           &AtomicLayerProcess<T, D>::disableCycleExtrapolation,
+           "Trace every cycle of the process.")
       .def("enableRandomSeeds", &AtomicLayerProcess<T, D>::enableRandomSeeds,
            "Enable random seeds for the ray tracer. This will make the process "
            "results non-deterministic.")
@@ -1080,8 +1321,9 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
            pybind11::arg("domain"), pybind11::arg("model"),
            pybind11::arg("duration"))
       // methods
-      .def("apply", &Process<T, D>::apply, "Run the process.")
-      .def("calculateFlux", &Process<T, D>::calculateFlux,
+      .def("apply", &Process<T, D>::apply, ReleaseGIL(),
+           "Run the process.")
+      .def("calculateFlux", &Process<T, D>::calculateFlux, ReleaseGIL(),
            "Perform a single-pass flux calculation.")
       .def("setDomain", &Process<T, D>::setDomain, "Set the process domain.")
       .def("setProcessModel", &Process<T, D>::setProcessModel,
@@ -1160,16 +1402,17 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def("getGrid", &Domain<T, D>::getGrid, "Get the grid")
       .def("print", &Domain<T, D>::print)
       .def("saveLevelSetMesh", &Domain<T, D>::saveLevelSetMesh,
-           pybind11::arg("filename"), pybind11::arg("width") = 1,
+           pybind11::arg("filename"), pybind11::arg("width") = 1, ReleaseGIL(),
            "Save the level set grids of layers in the domain.")
       .def("saveSurfaceMesh", &Domain<T, D>::saveSurfaceMesh,
            pybind11::arg("filename"), pybind11::arg("addMaterialIds") = false,
+           ReleaseGIL(),
            "Save the surface of the domain.")
       .def("saveVolumeMesh", &Domain<T, D>::saveVolumeMesh,
-           pybind11::arg("filename"),
+           pybind11::arg("filename"), ReleaseGIL(),
            "Save the volume representation of the domain.")
       .def("saveLevelSets", &Domain<T, D>::saveLevelSets,
-           pybind11::arg("filename"))
+           pybind11::arg("filename"), ReleaseGIL())
       .def("clear", &Domain<T, D>::clear);
 
   // MaterialMap
@@ -1211,6 +1454,51 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
   //                                  OTHER
   //   ***************************************************************************
 
+  // Numpy views of mesh data. The returned arrays alias the data of the mesh
+  // instead of copying it.
+  static_assert(sizeof(std::array<T, 3>) == 3 * sizeof(T));
+  module.def(
+      "meshNodes",
+      [](SmartPointer<viennals::Mesh<T>> mesh) {
+        auto &nodes = mesh->getNodes();
+        return makeArrayView(
+            nodes.empty() ? nullptr : nodes.front().data(),
+            {static_cast<pybind11::ssize_t>(nodes.size()), 3}, mesh);
+      },
+      pybind11::arg("mesh"),
+      "Get the nodes of a mesh as an (N, 3) numpy array without copying.");
+  module.def(
+      "meshScalarData",
+      [](SmartPointer<viennals::Mesh<T>> mesh, const std::string &label,
+         bool pointData) {
+        auto data = getMeshData(*mesh, pointData).getScalarData(label, true);
+        if (!data)
+          throw pybind11::key_error("No scalar data '" + label + "' in mesh.");
+        return makeArrayView(data->data(),
+                             {static_cast<pybind11::ssize_t>(data->size())},
+                             mesh);
+      },
+      pybind11::arg("mesh"), pybind11::arg("label"),
+      pybind11::arg("pointData") = false,
+      "Get scalar data of a mesh (e.g. fluxes from Process.calculateFlux) as "
+      "a numpy array without copying. By default the cell data is used, which "
+      "holds the data of disk meshes.");
+  module.def(
+      "meshVectorData",
+      [](SmartPointer<viennals::Mesh<T>> mesh, const std::string &label,
+         bool pointData) {
+        auto data = getMeshData(*mesh, pointData).getVectorData(label, true);
+        if (!data)
+          throw pybind11::key_error("No vector data '" + label + "' in mesh.");
+        return makeArrayView(
+            data->empty() ? nullptr : data->front().data(),
+            {static_cast<pybind11::ssize_t>(data->size()), 3}, mesh);
+      },
+      pybind11::arg("mesh"), pybind11::arg("label"),
+      pybind11::arg("pointData") = false,
+      "Get vector data of a mesh (e.g. normals) as an (N, 3) numpy array "
+      "without copying.");
+
   // Constants
   auto m_constants =
       module.def_submodule("constants", "Physical and material constants.");
@@ -1260,9 +1548,31 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def("setBoundaryPadding", &GDSGeometry<T, D>::setBoundaryPadding,
            "Set padding between the largest point of the geometry and the "
            "boundary of the domain.")
+      .def("setSimulationWindow", &GDSGeometry<T, D>::setSimulationWindow,
+           pybind11::arg("xMin"), pybind11::arg("yMin"), pybind11::arg("xMax"),
+           pybind11::arg("yMax"),
+           "Only convert the part of the layout inside the window. The "
+           "domain bounds are set to the window.")
+      .def("clearSimulationWindow", &GDSGeometry<T, D>::clearSimulationWindow,
+           "Convert the whole layout.")
       .def("print", &GDSGeometry<T, D>::print, "Print the geometry contents.")
       .def("layerToLevelSet", &GDSGeometry<T, D>::layerToLevelSet,
+           ReleaseGIL(),
            "Convert a layer of the GDS geometry to a level set domain.")
+      .def(
+          "layersToLevelSets",
+          [](GDSGeometry<T, D> &gds,
+             const std::vector<std::tuple<int16_t, T, T, bool>> &layers) {
+            std::vector<typename GDSGeometry<T, D>::LayerSpec> specs;
+            specs.reserve(layers.size());
+            for (const auto &[layer, baseHeight, height, mask] : layers)
+              specs.push_back({layer, baseHeight, height, mask});
+            pybind11::gil_scoped_release release;
+            return gds.layersToLevelSets(specs);
+          },
+          pybind11::arg("layers"),
+          "Convert several layers given as (layer, baseHeight, height, mask) "
+          "concurrently.")
       .def(
           "getBounds",
           [](GDSGeometry<T, D> &gds) -> std::array<double, 6> {
@@ -1283,7 +1593,8 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
            "Set the domain to be parsed in.")
       .def("setFileName", &GDSReader<T, D>::setFileName,
            "Set name of the GDS file.")
-      .def("apply", &GDSReader<T, D>::apply, "Parse the GDS file.");
+      .def("apply", &GDSReader<T, D>::apply, ReleaseGIL(),
+           "Parse the GDS file.");
 #else
   // wrap a 3D domain in 2D mode to be used with psExtrude
   // Domain
@@ -1316,15 +1627,17 @@ PYBIND11_MODULE(VIENNAPS_MODULE_NAME, module) {
       .def("getGrid", &Domain<T, 3>::getGrid, "Get the grid")
       .def("print", &Domain<T, 3>::print)
       .def("saveLevelSetMesh", &Domain<T, 3>::saveLevelSetMesh,
-           pybind11::arg("filename"), pybind11::arg("width") = 1,
+           pybind11::arg("filename"), pybind11::arg("width") = 1, ReleaseGIL(),
            "Save the level set grids of layers in the domain.")
       .def("saveSurfaceMesh", &Domain<T, 3>::saveSurfaceMesh,
            pybind11::arg("filename"), pybind11::arg("addMaterialIds") = false,
+           ReleaseGIL(),
            "Save the surface of the domain.")
       .def("saveVolumeMesh", &Domain<T, 3>::saveVolumeMesh,
-           pybind11::arg("filename"),
+           pybind11::arg("filename"), ReleaseGIL(),
            "Save the volume representation of the domain.")
-      .def("saveLevelSets", &Domain<T, 3>::saveLevelSets)
+      .def("saveLevelSets", &Domain<T, 3>::saveLevelSets,
+           pybind11::arg("filename"), ReleaseGIL())
       .def("clear", &Domain<T, 3>::clear);
 
   pybind11::class_<Extrude<T>>(module, "Extrude")
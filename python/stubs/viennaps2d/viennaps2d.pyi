@@ -1,5 +1,6 @@
 from _typeshed import Incomplete
-from typing import ClassVar, List, Tuple, overload
+from typing import ClassVar, Dict, List, Tuple, overload
+import numpy
 
 Air: Material
 Al2O3: Material
@@ -47,6 +48,8 @@ class AnisotropicProcess(ProcessModel):
     def __init__(self, materials: List[Tuple[Material, float]]) -> None: ...
     @overload
     def __init__(self, direction100, direction010, rate100: float, rate110: float, rate111: float, rate311: float, materials: List[Tuple[Material, float]]) -> None: ...
+    def disableLookupTable(self) -> None: ...
+    def enableLookupTable(self, tolerance: float = ...) -> None: ...
 
 class AtomicLayerProcess:
     @overload
@@ -56,7 +59,9 @@ class AtomicLayerProcess:
     @overload
     def __init__(self, domain: Domain, processModel: ProcessModel) -> None: ...
     def apply(self) -> None: ...
+    def disableCycleExtrapolation(self) -> None: ...
     def disableRandomSeeds(self) -> None: ...
+    def enableCycleExtrapolation(self, driftTolerance: float = ...) -> None: ...
     def enableRandomSeeds(self) -> None: ...
     def setCoverageTimeStep(self, arg0: float) -> None: ...
     def setDesorptionRates(self, arg0: List[float]) -> None: ...
@@ -113,11 +118,17 @@ class BoxDistribution(ProcessModel):
 #     def writeCellSetData(self, arg0: str) -> None: ...
 #     def writeVTU(self, arg0: str) -> None: ...
 
+class DefaultVelocityField(VelocityField):
+    def __init__(self, translationFieldOptions: int = ...) -> None: ...
+    def setVelocities(self, velocities: numpy.ndarray) -> numpy.ndarray | None: ...
+
 class DirectionalEtching(ProcessModel):
     @overload
     def __init__(self, direction, directionalVelocity: float = ..., isotropicVelocity: float = ..., maskMaterial: Material = ...) -> None: ...
     @overload
     def __init__(self, direction, directionalVelocity: float, isotropicVelocity: float, maskMaterial: List[Material]) -> None: ...
+    def disableGeometricSweep(self) -> None: ...
+    def enableGeometricSweep(self) -> None: ...
 
 class Domain:
     def __init__(self) -> None: ...
@@ -154,7 +165,7 @@ class Domain3D:
     def print(self) -> None: ...
     def removeTopLevelSet(self) -> None: ...
     def saveLevelSetMesh(self, filename: str, width: int = ...) -> None: ...
-    def saveLevelSets(self, arg0: str) -> None: ...
+    def saveLevelSets(self, filename: str) -> None: ...
     def saveSurfaceMesh(self, filename: str, addMaterialIds: bool = ...) -> None: ...
     def saveVolumeMesh(self, filename: str) -> None: ...
     def setMaterialMap(self, arg0: MaterialMap) -> None: ...
@@ -257,6 +268,8 @@ class IsotropicProcess(ProcessModel):
     def __init__(self, rate: float = ..., maskMaterial: Material = ...) -> None: ...
     @overload
     def __init__(self, rate: float, maskMaterial: List[Material]) -> None: ...
+    def disableAnalyticOffset(self) -> None: ...
+    def enableAnalyticOffset(self) -> None: ...
 
 class LogLevel:
     __members__: ClassVar[dict] = ...  # read-only
@@ -380,6 +393,8 @@ class MaterialMap:
 
 class OxideRegrowth(ProcessModel):
     def __init__(self, nitrideEtchRate: float, oxideEtchRate: float, redepositionRate: float, redepositionThreshold: float, redepositionTimeInt: float, diffusionCoefficient: float, sinkStrength: float, scallopVelocity: float, centerVelocity: float, topHeight: float, centerWidth: float, stabilityFactor: float) -> None: ...
+    def disableImplicitDiffusion(self) -> None: ...
+    def enableImplicitDiffusion(self) -> None: ...
 
 class Particle:
     def __init__(self, *args, **kwargs) -> None: ...
@@ -547,6 +562,17 @@ class SingleParticleALD(ProcessModel):
 class SphereDistribution(ProcessModel):
     def __init__(self, radius: float, gridDelta: float) -> None: ...
 
+class SurfaceModel:
+    def __init__(self) -> None: ...
+    def calculateVelocities(self, rates: Dict[str, numpy.ndarray], coordinates: numpy.ndarray, materialIds: numpy.ndarray) -> numpy.ndarray | None: ...
+    def getCoverages(self) -> Dict[str, numpy.ndarray]: ...
+    def getProcessParameters(self) -> ProcessParams: ...
+    def initializeCoverages(self, numGeometryPoints: int) -> None: ...
+    def initializeProcessParameters(self) -> None: ...
+    def setCoverage(self, label: str, values: List[float]) -> None: ...
+    def setProcessParameters(self, params: ProcessParams) -> None: ...
+    def updateCoverages(self, rates: Dict[str, numpy.ndarray], materialIds: numpy.ndarray) -> None: ...
+
 class TEOSDeposition(ProcessModel):
     def __init__(self, stickingProbabilityP1: float, rateP1: float, orderP1: float, stickingProbabilityP2: float = ..., rateP2: float = ..., orderP2: float = ...) -> None: ...
 
@@ -568,6 +594,11 @@ class ToDiskMesh:
     def setDomain(self, arg0: Domain) -> None: ...
     def setMesh(self, arg0) -> None: ...
 
+class VelocityField:
+    def __init__(self) -> None: ...
+    def getTranslationFieldOptions(self) -> int: ...
+    def setVelocities(self, velocities: numpy.ndarray) -> numpy.ndarray | None: ...
+
 class rayTraceDirection:
     __members__: ClassVar[dict] = ...  # read-only
     NEG_X: ClassVar[rayTraceDirection] = ...
@@ -588,4 +619,7 @@ class rayTraceDirection:
     @property
     def value(self) -> int: ...
 
+def meshNodes(mesh) -> numpy.ndarray: ...
+def meshScalarData(mesh, label: str, pointData: bool = ...) -> numpy.ndarray: ...
+def meshVectorData(mesh, label: str, pointData: bool = ...) -> numpy.ndarray: ...
 def setNumThreads(arg0: int) -> None: ...
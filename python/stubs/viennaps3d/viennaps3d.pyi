@@ -1,5 +1,6 @@
 from _typeshed import Incomplete
-from typing import ClassVar, List, Tuple, overload, Annotated, FixedSize
+from typing import ClassVar, Dict, List, Tuple, overload, Annotated, FixedSize
+import numpy
 # from viennals3d import *
 
 Air: Material
@@ -48,6 +49,8 @@ class AnisotropicProcess(ProcessModel):
     def __init__(self, materials: List[Tuple[Material, float]]) -> None: ...
     @overload
     def __init__(self, direction100, direction010, rate100: float, rate110: float, rate111: float, rate311: float, materials: List[Tuple[Material, float]]) -> None: ...
+    def disableLookupTable(self) -> None: ...
+    def enableLookupTable(self, tolerance: float = ...) -> None: ...
 
 class AtomicLayerProcess:
     @overload
@@ -57,7 +60,9 @@ class AtomicLayerProcess:
     @overload
     def __init__(self, domain: Domain, processModel: ProcessModel) -> None: ...
     def apply(self) -> None: ...
+    def disableCycleExtrapolation(self) -> None: ...
     def disableRandomSeeds(self) -> None: ...
+    def enableCycleExtrapolation(self, driftTolerance: float = ...) -> None: ...
     def enableRandomSeeds(self) -> None: ...
     def setCoverageTimeStep(self, arg0: float) -> None: ...
     def setDesorptionRates(self, arg0: List[float]) -> None: ...
@@ -114,11 +119,17 @@ class BoxDistribution(ProcessModel):
 #     def writeCellSetData(self, arg0: str) -> None: ...
 #     def writeVTU(self, arg0: str) -> None: ...
 
+class DefaultVelocityField(VelocityField):
+    def __init__(self, translationFieldOptions: int = ...) -> None: ...
+    def setVelocities(self, velocities: numpy.ndarray) -> numpy.ndarray | None: ...
+
 class DirectionalEtching(ProcessModel):
     @overload
     def __init__(self, direction, directionalVelocity: float = ..., isotropicVelocity: float = ..., maskMaterial: Material = ...) -> None: ...
     @overload
     def __init__(self, direction, directionalVelocity: float, isotropicVelocity: float, maskMaterial: List[Material]) -> None: ...
+    def disableGeometricSweep(self) -> None: ...
+    def enableGeometricSweep(self) -> None: ...
 
 class Domain:
     def __init__(self) -> None: ...
@@ -226,12 +237,15 @@ class GDSGeometry:
     def __init__(self) -> None: ...
     @overload
     def __init__(self, gridDelta: float) -> None: ...
+    def clearSimulationWindow(self) -> None: ...
     def getBounds(self, *args, **kwargs): ...
     def layerToLevelSet(self, *args, **kwargs): ...
+    def layersToLevelSets(self, layers: List[Tuple[int, float, float, bool]]) -> list: ...
     def print(self) -> None: ...
     def setBoundaryConditions(self, arg0) -> None: ...
     def setBoundaryPadding(self, arg0: float, arg1: float) -> None: ...
     def setGridDelta(self, arg0: float) -> None: ...
+    def setSimulationWindow(self, xMin: float, yMin: float, xMax: float, yMax: float) -> None: ...
 
 class GDSReader:
     @overload
@@ -247,6 +261,8 @@ class IsotropicProcess(ProcessModel):
     def __init__(self, rate: float = ..., maskMaterial: Material = ...) -> None: ...
     @overload
     def __init__(self, rate: float, maskMaterial: List[Material]) -> None: ...
+    def disableAnalyticOffset(self) -> None: ...
+    def enableAnalyticOffset(self) -> None: ...
 
 class LogLevel:
     __members__: ClassVar[dict] = ...  # read-only
@@ -370,6 +386,8 @@ class MaterialMap:
 
 class OxideRegrowth(ProcessModel):
     def __init__(self, nitrideEtchRate: float, oxideEtchRate: float, redepositionRate: float, redepositionThreshold: float, redepositionTimeInt: float, diffusionCoefficient: float, sinkStrength: float, scallopVelocity: float, centerVelocity: float, topHeight: float, centerWidth: float, stabilityFactor: float) -> None: ...
+    def disableImplicitDiffusion(self) -> None: ...
+    def enableImplicitDiffusion(self) -> None: ...
 
 class Particle:
     def __init__(self, *args, **kwargs) -> None: ...
@@ -537,6 +555,17 @@ class SingleParticleALD(ProcessModel):
 class SphereDistribution(ProcessModel):
     def __init__(self, radius: float, gridDelta: float) -> None: ...
 
+class SurfaceModel:
+    def __init__(self) -> None: ...
+    def calculateVelocities(self, rates: Dict[str, numpy.ndarray], coordinates: numpy.ndarray, materialIds: numpy.ndarray) -> numpy.ndarray | None: ...
+    def getCoverages(self) -> Dict[str, numpy.ndarray]: ...
+    def getProcessParameters(self) -> ProcessParams: ...
+    def initializeCoverages(self, numGeometryPoints: int) -> None: ...
+    def initializeProcessParameters(self) -> None: ...
+    def setCoverage(self, label: str, values: List[float]) -> None: ...
+    def setProcessParameters(self, params: ProcessParams) -> None: ...
+    def updateCoverages(self, rates: Dict[str, numpy.ndarray], materialIds: numpy.ndarray) -> None: ...
+
 class TEOSDeposition(ProcessModel):
     def __init__(self, stickingProbabilityP1: float, rateP1: float, orderP1: float, stickingProbabilityP2: float = ..., rateP2: float = ..., orderP2: float = ...) -> None: ...
 
@@ -558,6 +587,11 @@ class ToDiskMesh:
     def setDomain(self, arg0: Domain) -> None: ...
     def setMesh(self, arg0) -> None: ...
 
+class VelocityField:
+    def __init__(self) -> None: ...
+    def getTranslationFieldOptions(self) -> int: ...
+    def setVelocities(self, velocities: numpy.ndarray) -> numpy.ndarray | None: ...
+
 class rayTraceDirection:
     __members__: ClassVar[dict] = ...  # read-only
     NEG_X: ClassVar[rayTraceDirection] = ...
@@ -578,4 +612,7 @@ class rayTraceDirection:
     @property
     def value(self) -> int: ...
 
+def meshNodes(mesh) -> numpy.ndarray: ...
+def meshScalarData(mesh, label: str, pointData: bool = ...) -> numpy.ndarray: ...
+def meshVectorData(mesh, label: str, pointData: bool = ...) -> numpy.ndarray: ...
 def setNumThreads(arg0: int) -> None: ...
@@ -0,0 +1,75 @@
+#include <models/psAnisotropicProcess.hpp>
+
+#include <vcTestAsserts.hpp>
+
+#include <cmath>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+template <class NumericType, int D> void RunTest() {
+  Logger::setLogLevel(LogLevel::WARNING);
+
+  // default crystal directions and rates of AnisotropicProcess
+  Vec3D<NumericType> direction100, direction010;
+  if constexpr (D == 2) {
+    direction100 = {0., 1., 0.};
+    direction010 = {1., 0., -1.};
+  } else {
+    direction100 = {0.707106781187, 0.707106781187, 0};
+    direction010 = {-0.707106781187, 0.707106781187, 0.};
+  }
+  const NumericType r100 = 0.0166666666667;
+  const NumericType r110 = 0.0309166666667;
+  const NumericType r111 = 0.000121666666667;
+  const NumericType r311 = 0.0300166666667;
+  const NumericType maxRate = std::max({r100, r110, r111, r311});
+  const std::vector<std::pair<Material, NumericType>> materials = {
+      {Material::Si, 1.}};
+  const int material = static_cast<int>(Material::Si);
+
+  using FieldType = impl::AnisotropicVelocityField<NumericType, D>;
+  FieldType analytic(direction100, direction010, r100, r110, r111, r311,
+                     materials);
+  FieldType interpolated(direction100, direction010, r100, r110, r111, r311,
+                         materials);
+
+  const NumericType tolerance = 1e-2;
+  interpolated.buildLookupTable(tolerance);
+
+  // sample normals over the whole unit sphere (circle in 2D)
+  const Vec3D<NumericType> coordinate{0., 0., 0.};
+  const int numPolar = D == 3 ? 90 : 1;
+  const int numAzimuthal = 360;
+  NumericType maxError = 0.;
+  for (int p = 0; p < numPolar; ++p) {
+    const NumericType theta = D == 3 ? M_PI * (p + 0.5) / numPolar : M_PI / 2;
+    for (int a = 0; a < numAzimuthal; ++a) {
+      const NumericType phi = 2 * M_PI * (a + 0.3) / numAzimuthal;
+      Vec3D<NumericType> normal{std::sin(theta) * std::cos(phi),
+                                std::sin(theta) * std::sin(phi), 0.};
+      if constexpr (D == 3)
+        normal[2] = std::cos(theta);
+      Normalize(normal);
+
+      const NumericType exact =
+          analytic.getScalarVelocity(coordinate, material, normal, 0);
+      const NumericType approx =
+          interpolated.getScalarVelocity(coordinate, material, normal, 0);
+      maxError = std::max(maxError, std::abs(approx - exact) / maxRate);
+    }
+  }
+  VC_TEST_ASSERT(maxError <= tolerance);
+
+  // without the table the analytic velocity is used again
+  interpolated.clearLookupTable();
+  Vec3D<NumericType> normal{0.6, 0.8, 0.};
+  VC_TEST_ASSERT(interpolated.getScalarVelocity(coordinate, material, normal,
+                                                0) ==
+                 analytic.getScalarVelocity(coordinate, material, normal, 0));
+}
+
+} // namespace viennacore
+
+int main() { VC_RUN_ALL_TESTS }
@@ -0,0 +1,54 @@
+#include <geometries/psMakeTrench.hpp>
+#include <models/psSingleParticleALD.hpp>
+
+#include <lsTestAsserts.hpp>
+#include <psAtomicLayerProcess.hpp>
+#include <psConstants.hpp>
+#include <psDomain.hpp>
+#include <vcTestAsserts.hpp>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+template <class NumericType, int D>
+unsigned runCycles(NumericType growthPerCycle, unsigned numCycles) {
+  auto domain = SmartPointer<Domain<NumericType, D>>::New();
+  MakeTrench<NumericType, D>(domain, 1., 10., 5., 4., 4.).apply();
+  domain->duplicateTopLevelSet(Material::Al2O3);
+
+  const NumericType gasMFP = constants::gasMeanFreePath(0.1, 220., 2.75);
+  auto model = SmartPointer<SingleParticleALD<NumericType, D>>::New(
+      1., numCycles, growthPerCycle, numCycles, 0.01, 0., 1e3, 1., gasMFP);
+
+  AtomicLayerProcess<NumericType, D> process(domain, model);
+  process.setCoverageTimeStep(0.01);
+  process.setPulseTime(0.05);
+  process.setNumCycles(numCycles);
+  process.setNumberOfRaysPerPoint(10);
+  process.disableRandomSeeds();
+  process.enableCycleExtrapolation(0.5);
+  process.apply();
+
+  LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
+  return process.getNumberOfTracedCycles();
+}
+
+template <class NumericType, int D> void RunTest() {
+  Logger::setLogLevel(LogLevel::WARNING);
+  constexpr unsigned numCycles = 4;
+
+  // small growth per cycle: cycles are merged
+  VC_TEST_ASSERT((runCycles<NumericType, D>(0.01, numCycles)) < numCycles);
+
+  // a single cycle grows more than the tolerance: every cycle is traced
+  VC_TEST_ASSERT((runCycles<NumericType, D>(1., numCycles)) == numCycles);
+}
+
+} // namespace viennacore
+
+// SingleParticleALD is only implemented for double precision
+int main() {
+  viennacore::RunTest<double, 2>();
+  viennacore::RunTest<double, 3>();
+}
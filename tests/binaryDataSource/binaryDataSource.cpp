@@ -0,0 +1,126 @@
+#include <compact/psBinaryDataSource.hpp>
+
+#include <vcTestAsserts.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+template <class NumericType, int D> void RunTest() {
+  using OtherType =
+      std::conditional_t<std::is_same_v<NumericType, float>, double, float>;
+  const std::string fileName = "binaryDataSourceTest.bin";
+
+  const std::size_t numRows = 1000, numCols = 5;
+  typename DataSource<NumericType>::VectorType data(numRows);
+  for (std::size_t i = 0; i < numRows; ++i)
+    for (std::size_t j = 0; j < numCols; ++j)
+      data[i].push_back(static_cast<NumericType>(i) + 0.25 * j);
+  const std::vector<NumericType> positional = {1.5, -2.};
+  const std::unordered_map<std::string, NumericType> named = {
+      {"depth", 4.5}, {"taperAngle", -0.25}, {"x", 0.}};
+
+  // write the data with the parameters
+  {
+    BinaryDataSource<NumericType> source(fileName);
+    source.setData(data);
+    source.setPositionalParameters(positional);
+    source.setNamedParameters(named);
+    VC_TEST_ASSERT(source.sync());
+  }
+
+  // read it back with the same precision
+  DataView<NumericType> firstView;
+  {
+    BinaryDataSource<NumericType> source(fileName);
+    VC_TEST_ASSERT(*source.getData() == data);
+    VC_TEST_ASSERT(source.getPositionalParameters() == positional);
+    VC_TEST_ASSERT(source.getNamedParameters() == named);
+
+    firstView = source.getView();
+    VC_TEST_ASSERT(firstView.rows() == numRows);
+    VC_TEST_ASSERT(firstView.cols() == numCols);
+    VC_TEST_ASSERT(firstView.isColumnContiguous());
+    for (std::size_t i = 0; i < numRows; ++i)
+      for (std::size_t j = 0; j < numCols; ++j)
+        VC_TEST_ASSERT(firstView(i, j) == data[i][j]);
+  }
+
+  // read it back with the other precision
+  {
+    BinaryDataSource<OtherType> source(fileName);
+    auto converted = source.getData();
+    VC_TEST_ASSERT(converted->size() == numRows);
+    for (std::size_t i = 0; i < numRows; ++i)
+      for (std::size_t j = 0; j < numCols; ++j)
+        VC_TEST_ASSERT(converted->at(i)[j] ==
+                       static_cast<OtherType>(data[i][j]));
+
+    auto convertedPositional = source.getPositionalParameters();
+    VC_TEST_ASSERT(convertedPositional.size() == positional.size());
+    for (std::size_t i = 0; i < positional.size(); ++i)
+      VC_TEST_ASSERT(convertedPositional[i] ==
+                     static_cast<OtherType>(positional[i]));
+
+    auto convertedNamed = source.getNamedParameters();
+    VC_TEST_ASSERT(convertedNamed.size() == named.size());
+    for (const auto &[key, value] : named)
+      VC_TEST_ASSERT(convertedNamed.at(key) == static_cast<OtherType>(value));
+  }
+
+  // overwriting the file keeps earlier views valid
+  {
+    BinaryDataSource<NumericType> source(fileName);
+    source.setData({{1., 2.}});
+    VC_TEST_ASSERT(source.sync());
+    VC_TEST_ASSERT(source.getPositionalParameters().empty());
+    VC_TEST_ASSERT(source.getNamedParameters().empty());
+    VC_TEST_ASSERT(source.getView().rows() == 1);
+    VC_TEST_ASSERT(firstView(numRows - 1, numCols - 1) ==
+                   data[numRows - 1][numCols - 1]);
+  }
+
+  // invalid files are rejected
+  {
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+    std::fputs("not a binary data source", file);
+    std::fclose(file);
+    BinaryDataSource<NumericType> source(fileName);
+    VC_TEST_ASSERT(source.getView().empty());
+    VC_TEST_ASSERT(source.getData()->empty());
+  }
+
+  // a header with an overflowing number of values is rejected
+  {
+    BinaryDataSource<NumericType> source(fileName);
+    source.setData(data);
+    VC_TEST_ASSERT(source.sync());
+  }
+  {
+    // number of rows and columns follow the first 24 bytes of the header
+    const uint64_t size[2] = {uint64_t(1) << 62, 8};
+    std::FILE *file = std::fopen(fileName.c_str(), "r+b");
+    std::fseek(file, 24, SEEK_SET);
+    std::fwrite(size, sizeof(uint64_t), 2, file);
+    std::fclose(file);
+    BinaryDataSource<NumericType> source(fileName);
+    VC_TEST_ASSERT(source.getView().empty());
+    VC_TEST_ASSERT(source.getData()->empty());
+  }
+
+  std::remove(fileName.c_str());
+}
+
+} // namespace viennacore
+
+// The data source does not depend on the dimension
+int main() {
+  viennacore::Logger::setLogLevel(viennacore::LogLevel::ERROR);
+  viennacore::RunTest<double, 2>();
+  viennacore::RunTest<float, 2>();
+}
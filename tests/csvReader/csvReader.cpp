@@ -0,0 +1,100 @@
+#include <compact/psCSVDataSource.hpp>
+#include <compact/psCSVReader.hpp>
+
+#include <vcTestAsserts.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+// Fixed width row, so that the chunk boundary falls inside a row
+std::string makeRow(int i) {
+  std::string index = std::to_string(i);
+  return std::string(7 - index.size(), '0') + index + ",0.25,-3.5";
+}
+
+constexpr std::size_t rowWidth = 7 + 5 + 5;
+
+void writeFile(const std::string &fileName, const std::string &header,
+               int numRows, const std::string &lineEnd, int badRow = -1) {
+  std::ofstream file(fileName, std::ios::binary);
+  file << header;
+  for (int i = 0; i < numRows; ++i)
+    file << (i == badRow ? "0000000,abcd,-3.5" : makeRow(i)) << lineEnd;
+}
+
+template <class NumericType, int D> void RunTest() {
+  const std::string fileName = "csvReaderTest.csv";
+  const std::string header = "#!1.5,2.5\r\n#!width=3,depth=4.5\r\n"
+                             "# plain comment\r\n";
+  const int numHeaderLines = 3;
+  // one and a half chunks
+  const int numRows = static_cast<int>((3 << 19) / (rowWidth + 2)) + 1;
+  VC_TEST_ASSERT(((1 << 20) - header.size()) % (rowWidth + 2) != 0);
+
+  // rows spanning the chunk boundary with CRLF line endings
+  {
+    writeFile(fileName, header, numRows, "\r\n");
+    CSVReader<NumericType> reader(fileName);
+    auto headerOpt = reader.readHeader();
+    VC_TEST_ASSERT(headerOpt.has_value());
+    VC_TEST_ASSERT(headerOpt->find("#!width=3,depth=4.5") !=
+                   std::string::npos);
+    VC_TEST_ASSERT(headerOpt->find('\r') == std::string::npos);
+
+    auto content = reader.readContent();
+    VC_TEST_ASSERT(content.has_value());
+    VC_TEST_ASSERT(reader.getErrorLine() == -1);
+    VC_TEST_ASSERT(static_cast<int>(content->size()) == numRows);
+    for (int i = 0; i < numRows; ++i) {
+      const auto &row = content->at(i);
+      VC_TEST_ASSERT(row.size() == 3);
+      VC_TEST_ASSERT(row[0] == NumericType(i));
+      VC_TEST_ASSERT(row[1] == NumericType(0.25));
+      VC_TEST_ASSERT(row[2] == NumericType(-3.5));
+    }
+  }
+
+  // parameters from the '#!' header lines
+  {
+    CSVDataSource<NumericType> source(fileName);
+    auto data = source.read();
+    VC_TEST_ASSERT(static_cast<int>(data.size()) == numRows);
+
+    auto positional = source.getPositionalParameters();
+    VC_TEST_ASSERT(positional.size() == 2);
+    VC_TEST_ASSERT(positional[0] == NumericType(1.5));
+    VC_TEST_ASSERT(positional[1] == NumericType(2.5));
+
+    auto named = source.getNamedParameters();
+    VC_TEST_ASSERT(named.size() == 2);
+    VC_TEST_ASSERT(named["width"] == NumericType(3));
+    VC_TEST_ASSERT(named["depth"] == NumericType(4.5));
+  }
+
+  // zero-based line of a malformed row in the first and in the second chunk
+  for (const int badRow : {10, numRows - 10}) {
+    for (const std::string lineEnd : {"\n", "\r\n"}) {
+      writeFile(fileName, header, numRows, lineEnd, badRow);
+      CSVReader<NumericType> reader(fileName);
+      VC_TEST_ASSERT(!reader.readContent().has_value());
+      VC_TEST_ASSERT(reader.getErrorLine() == numHeaderLines + badRow);
+    }
+  }
+
+  std::remove(fileName.c_str());
+}
+
+} // namespace viennacore
+
+// The reader does not depend on the dimension
+int main() {
+  viennacore::Logger::setLogLevel(viennacore::LogLevel::ERROR);
+  viennacore::RunTest<double, 2>();
+  viennacore::RunTest<float, 2>();
+}
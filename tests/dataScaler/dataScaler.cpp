@@ -0,0 +1,114 @@
+#include <compact/psDataScaler.hpp>
+
+#include <vcTestAsserts.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+// Number of pairs of the sorted values with a distance of at most d
+template <class NumericType>
+std::size_t countPairs(const std::vector<NumericType> &sorted, double d) {
+  std::size_t count = 0, k = 0;
+  for (std::size_t j = 0; j < sorted.size(); ++j) {
+    while (sorted[j] - sorted[k] > d)
+      ++k;
+    count += j - k;
+  }
+  return count;
+}
+
+template <class NumericType, int D> void RunTest() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<NumericType> uniform(-3., 5.);
+  std::normal_distribution<NumericType> normal(1., 2.);
+
+  // the median is sampled for large data sets
+  {
+    const std::size_t size = 20000;
+    const NumericType rankError = 0.01;
+    std::vector<std::vector<NumericType>> data(size);
+    for (auto &item : data)
+      item = {uniform(rng), normal(rng)};
+
+    MedianDistanceScaler<NumericType> scaler(data);
+    scaler.setErrorBound(rankError);
+    scaler.apply();
+    const auto factors = scaler.getScalingFactors();
+    VC_TEST_ASSERT(factors.size() == 2);
+
+    // the rank of the sampled median among all pairwise distances
+    const double numPairs = size * (size - 1) / 2.;
+    for (int i = 0; i < 2; ++i) {
+      std::vector<NumericType> values(size);
+      for (std::size_t j = 0; j < size; ++j)
+        values[j] = data[j][i];
+      std::sort(values.begin(), values.end());
+
+      const double median = 1. / factors[i];
+      const double below = countPairs(values, median * (1. - 1e-4)) / numPairs;
+      const double atMost = countPairs(values, median * (1. + 1e-4)) / numPairs;
+      VC_TEST_ASSERT(atMost >= 0.5 - rankError);
+      VC_TEST_ASSERT(below <= 0.5 + rankError);
+    }
+  }
+
+  // the median is exact for small data sets
+  {
+    const std::size_t size = 100;
+    std::vector<std::vector<NumericType>> data(size);
+    for (auto &item : data)
+      item = {uniform(rng)};
+
+    MedianDistanceScaler<NumericType> scaler(data);
+    scaler.apply();
+
+    std::vector<NumericType> distances;
+    for (std::size_t j = 1; j < size; ++j)
+      for (std::size_t k = 0; k < j; ++k)
+        distances.push_back(std::abs(data[j][0] - data[k][0]));
+    const auto medianIt = distances.begin() + distances.size() / 2;
+    std::nth_element(distances.begin(), medianIt, distances.end());
+    VC_TEST_ASSERT(scaler.getScalingFactors()[0] ==
+                   static_cast<NumericType>(1.0 / *medianIt));
+  }
+
+  // invalid error bounds keep the defaults
+  {
+    const std::size_t size = 2000;
+    std::vector<std::vector<NumericType>> data(size);
+    for (auto &item : data)
+      item = {normal(rng)};
+
+    MedianDistanceScaler<NumericType> reference(data);
+    reference.apply();
+
+    MedianDistanceScaler<NumericType> invalidConstructor(data, -0.1);
+    invalidConstructor.apply();
+    VC_TEST_ASSERT(invalidConstructor.getScalingFactors() ==
+                   reference.getScalingFactors());
+
+    MedianDistanceScaler<NumericType> invalidSetter(data);
+    invalidSetter.setErrorBound(0.);
+    invalidSetter.setErrorBound(0.01, 0.);
+    invalidSetter.setErrorBound(0.01, 1.);
+    invalidSetter.setErrorBound(std::nan(""), 0.5);
+    invalidSetter.apply();
+    VC_TEST_ASSERT(invalidSetter.getScalingFactors() ==
+                   reference.getScalingFactors());
+  }
+}
+
+} // namespace viennacore
+
+// The scaler does not depend on the dimension
+int main() {
+  viennacore::Logger::setLogLevel(viennacore::LogLevel::ERROR);
+  viennacore::RunTest<double, 2>();
+  viennacore::RunTest<float, 2>();
+}
@@ -2,10 +2,13 @@
 #include <models/psDirectionalEtching.hpp>
 
 #include <lsTestAsserts.hpp>
+#include <lsToSurfaceMesh.hpp>
 #include <psDomain.hpp>
 #include <psProcess.hpp>
 #include <vcTestAsserts.hpp>
 
+#include <cmath>
+
 namespace viennacore {
 
 using namespace viennaps;
@@ -59,6 +62,76 @@ template <class NumericType, int D> void RunTest() {
     VC_TEST_ASSERT(domain->getMaterialMap()->size() == 2);
     LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
   }
+
+  // Etching straight down removes the substrate only in the shadow of the
+  // mask opening, giving vertical walls and a flat bottom without undercut
+  {
+    const NumericType gridDelta = 1.;
+    const NumericType trenchWidth = 4.;
+    const NumericType maskHeight = 3.;
+    const NumericType baseHeight = 1.;
+    const NumericType rate = 1.;
+    const NumericType time = 2.5;
+    const NumericType bottom = baseHeight - rate * time;
+    Vec3D<NumericType> direction{0., 0., 0.};
+    direction[D - 1] = -1.;
+
+    for (const bool sweep : {true, false}) {
+      auto domain = SmartPointer<Domain<NumericType, D>>::New();
+      MakeTrench<NumericType, D>(domain, gridDelta, 12., 10., trenchWidth,
+                                 maskHeight, 0., baseHeight, false, true,
+                                 Material::Si)
+          .apply();
+      auto model = SmartPointer<DirectionalEtching<NumericType, D>>::New(
+          direction, rate, 0., Material::Mask);
+      if (sweep)
+        model->enableGeometricSweep();
+      Process<NumericType, D>(domain, model, time).apply();
+
+      VC_TEST_ASSERT(domain->getLevelSets().size() == 2);
+      LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
+
+      auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
+      viennals::ToSurfaceMesh<NumericType, D>(domain->getLevelSets().back(),
+                                              mesh)
+          .apply();
+      unsigned numBottomNodes = 0;
+      for (const auto &node : mesh->nodes) {
+        if (node[D - 1] > baseHeight - 0.5 * gridDelta)
+          continue;
+        // etched surface lies within the shadow of the mask
+        VC_TEST_ASSERT(std::abs(node[0]) < trenchWidth / 2 + 0.5 * gridDelta);
+        if (std::abs(node[0]) < trenchWidth / 2 - gridDelta) {
+          VC_TEST_ASSERT(std::abs(node[D - 1] - bottom) < 0.5 * gridDelta);
+          ++numBottomNodes;
+        }
+      }
+      VC_TEST_ASSERT(numBottomNodes > 0);
+
+      // the mask is not etched
+      viennals::ToSurfaceMesh<NumericType, D>(domain->getLevelSets().front(),
+                                              mesh)
+          .apply();
+      for (const auto &node : mesh->nodes)
+        VC_TEST_ASSERT(node[D - 1] > baseHeight - 0.25 * gridDelta);
+    }
+  }
+
+  {
+    Vec3D<NumericType> direction{0., 0., 0.};
+    direction[D - 1] = -1.;
+    auto directional = SmartPointer<DirectionalEtching<NumericType, D>>::New(
+        direction, 1., 0., Material::Mask);
+    directional->enableGeometricSweep();
+    VC_TEST_ASSERT(directional->getGeometricModel());
+
+    auto model = SmartPointer<DirectionalEtching<NumericType, D>>::New(
+        direction, 1., 0.5, Material::Mask);
+    model->enableGeometricSweep();
+
+    // the sweep is only available for purely directional etching
+    VC_TEST_ASSERT(!model->getGeometricModel());
+  }
 }
 } // namespace viennacore
 
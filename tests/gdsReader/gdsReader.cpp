@@ -1,10 +1,92 @@
 #include <psGDSReader.hpp>
+
+#include <lsToSurfaceMesh.hpp>
+
+#include <lsTestAsserts.hpp>
 #include <vcTestAsserts.hpp>
 
+#include <fstream>
+#include <iterator>
+
 namespace viennacore {
 
 using namespace viennaps;
 
+template <class NumericType, int D>
+NumericType surfaceArea(SmartPointer<viennals::Domain<NumericType, D>> layer) {
+  auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
+  viennals::ToSurfaceMesh<NumericType, D>(layer, mesh).apply();
+  NumericType area = 0.;
+  for (const auto &triangle : mesh->triangles) {
+    const auto &a = mesh->nodes[triangle[0]];
+    const auto &b = mesh->nodes[triangle[1]];
+    const auto &c = mesh->nodes[triangle[2]];
+    area += 0.5 * Norm(CrossProduct(b - a, c - a));
+  }
+  return area;
+}
+
+template <class NumericType>
+GDS::Structure<NumericType>
+rectangles(const std::string &name,
+           const std::vector<std::array<NumericType, 2>> &xRanges) {
+  GDS::Structure<NumericType> str;
+  str.name = name;
+  for (const auto &[xMin, xMax] : xRanges) {
+    str.elements.push_back(GDS::Element<NumericType>{
+        GDS::ElementType::elBoundary,
+        0,
+        -1,
+        {{xMin, 0., 0.}, {xMax, 0., 0.}, {xMax, 0.1, 0.}, {xMin, 0.1, 0.}}});
+  }
+  str.boundaryElements = static_cast<int>(xRanges.size());
+  str.containsLayers.insert(0);
+  str.elementBoundingBox = {
+      std::array<NumericType, 2>{xRanges.front()[0], 0.},
+      std::array<NumericType, 2>{xRanges.back()[1], 0.1}};
+  return str;
+}
+
+// Append a GDS record with big-endian length and type.
+void addRecord(std::vector<char> &file, unsigned char recordType,
+               unsigned char dataType, const std::vector<char> &payload) {
+  const auto length = static_cast<uint16_t>(payload.size() + 4);
+  file.push_back(static_cast<char>(length >> 8));
+  file.push_back(static_cast<char>(length & 0xff));
+  file.push_back(static_cast<char>(recordType));
+  file.push_back(static_cast<char>(dataType));
+  file.insert(file.end(), payload.begin(), payload.end());
+}
+
+std::vector<char> int16s(const std::vector<int16_t> &values) {
+  std::vector<char> bytes;
+  for (const auto v : values) {
+    bytes.push_back(static_cast<char>((v >> 8) & 0xff));
+    bytes.push_back(static_cast<char>(v & 0xff));
+  }
+  return bytes;
+}
+
+std::vector<char> int32s(const std::vector<int32_t> &values) {
+  std::vector<char> bytes;
+  for (const auto v : values)
+    for (int shift = 24; shift >= 0; shift -= 8)
+      bytes.push_back(static_cast<char>((v >> shift) & 0xff));
+  return bytes;
+}
+
+void writeFile(const std::string &fileName, const std::vector<char> &data) {
+  std::ofstream file(fileName, std::ios::binary);
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+template <class NumericType, int D>
+SmartPointer<GDSGeometry<NumericType, D>> readGDS(const std::string &file) {
+  auto geometry = SmartPointer<GDSGeometry<NumericType, D>>::New(0.01);
+  GDSReader<NumericType, D>(geometry, file).apply();
+  return geometry;
+}
+
 template <class NumericType, int D> void RunTest() {
   const NumericType gridDelta = 0.01;
   viennals::BoundaryConditionEnum<D> boundaryConditions[D] = {
@@ -14,6 +96,208 @@ template <class NumericType, int D> void RunTest() {
   auto mask = SmartPointer<GDSGeometry<NumericType, D>>::New(gridDelta);
   mask->setBoundaryConditions(boundaryConditions);
   GDSReader<NumericType, D> reader(mask, "mask.gds");
+  reader.apply();
+
+  {
+    // structure of the example mask as read by the original parser
+    const auto &structures = mask->getStructures();
+    VC_TEST_ASSERT(structures.size() == 1);
+    const auto &str = structures.front();
+    VC_TEST_ASSERT(str.name == "noname");
+    VC_TEST_ASSERT(str.elements.size() == 10);
+    VC_TEST_ASSERT(str.boundaryElements == 10);
+    VC_TEST_ASSERT(str.boxElements == 0);
+    VC_TEST_ASSERT(str.sRefs.empty() && str.aRefs.empty());
+    VC_TEST_ASSERT((str.containsLayers == std::set<int16_t>{0, 1, 2}));
+
+    std::array<int, 3> elementsPerLayer{};
+    for (const auto &element : str.elements) {
+      VC_TEST_ASSERT(element.layer >= 0 && element.layer < 3);
+      ++elementsPerLayer[element.layer];
+      // the closing point is not stored
+      VC_TEST_ASSERT(element.pointCloud.size() == 4);
+    }
+    VC_TEST_ASSERT((elementsPerLayer == std::array<int, 3>{4, 4, 2}));
+
+    const auto boundingBox = mask->getBoundingBox();
+    VC_TEST_ASSERT(std::abs(boundingBox[0][0] + 0.05) < 1e-6);
+    VC_TEST_ASSERT(std::abs(boundingBox[0][1]) < 1e-6);
+    VC_TEST_ASSERT(std::abs(boundingBox[1][0] - 0.7) < 1e-6);
+    VC_TEST_ASSERT(std::abs(boundingBox[1][1] - 0.5) < 1e-6);
+  }
+
+  {
+    // a truncated file keeps the complete structures only
+    std::ifstream file("mask.gds", std::ios::binary);
+    const std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+    VC_TEST_ASSERT(data.size() == 916);
+
+    // end of library missing
+    writeFile("truncated.gds", {data.begin(), data.end() - 4});
+    VC_TEST_ASSERT(readGDS<NumericType, D>("truncated.gds")
+                       ->getStructures()
+                       .front()
+                       .elements.size() == 10);
+
+    // inside the coordinates of the last element and inside a record header
+    for (const std::size_t size : {880, 910}) {
+      writeFile("truncated.gds", {data.begin(), data.begin() + size});
+      VC_TEST_ASSERT(
+          readGDS<NumericType, D>("truncated.gds")->getStructures().empty());
+    }
+  }
+
+  {
+    // odd-length structure name without padding
+    std::vector<char> data;
+    addRecord(data, 0x00, 0x02, int16s({7}));
+    addRecord(data, 0x01, 0x02, int16s(std::vector<int16_t>(12, 1)));
+    addRecord(data, 0x02, 0x06, {'l', 'i', 'b', '\0'});
+    // 1e-3 user units and 1e-9 m database units
+    addRecord(data, 0x03, 0x05,
+              {'\x3e', '\x41', '\x89', '\x37', '\x4b', '\xc6', '\xa7', '\xf0',
+               '\x39', '\x44', '\xb8', '\x2f', '\xa0', '\x9b', '\x5a', '\x54'});
+    addRecord(data, 0x05, 0x02, int16s(std::vector<int16_t>(12, 1)));
+    addRecord(data, 0x06, 0x06, {'a', 'b', 'c', 'd', 'e'});
+    addRecord(data, 0x08, 0x00, {});
+    addRecord(data, 0x0d, 0x02, int16s({3}));
+    addRecord(data, 0x0e, 0x02, int16s({0}));
+    addRecord(data, 0x10, 0x03,
+              int32s({0, 0, 100, 0, 100, 100, 0, 100, 0, 0}));
+    addRecord(data, 0x11, 0x00, {});
+    addRecord(data, 0x07, 0x00, {});
+    addRecord(data, 0x04, 0x00, {});
+    writeFile("odd.gds", data);
+
+    auto geometry = readGDS<NumericType, D>("odd.gds");
+    const auto &structures = geometry->getStructures();
+    VC_TEST_ASSERT(structures.size() == 1);
+    VC_TEST_ASSERT(structures.front().name == "abcde");
+    VC_TEST_ASSERT(structures.front().elements.size() == 1);
+    VC_TEST_ASSERT(structures.front().elements.front().layer == 3);
+    VC_TEST_ASSERT(std::abs(geometry->getBoundingBox()[1][0] - 0.1) < 1e-6);
+    VC_TEST_ASSERT(std::abs(geometry->getBoundingBox()[1][1] - 0.1) < 1e-6);
+  }
+
+  {
+    // square referenced twice and an overlapping rectangle
+    GDS::Structure<NumericType> square;
+    square.name = "square";
+    square.elements.push_back(GDS::Element<NumericType>{
+        GDS::ElementType::elBoundary,
+        0,
+        -1,
+        {{0., 0., 0.}, {0.1, 0., 0.}, {0.1, 0.1, 0.}, {0., 0.1, 0.}}});
+    square.boundaryElements = 1;
+    square.containsLayers.insert(0);
+    square.elementBoundingBox = {std::array<NumericType, 2>{0., 0.},
+                                 std::array<NumericType, 2>{0.1, 0.1}};
+
+    GDS::Structure<NumericType> top;
+    top.name = "top";
+    top.elements.push_back(GDS::Element<NumericType>{
+        GDS::ElementType::elBoundary,
+        0,
+        -1,
+        {{0.05, 0.02, 0.}, {0.25, 0.02, 0.}, {0.25, 0.08, 0.},
+         {0.05, 0.08, 0.}}});
+    top.boundaryElements = 1;
+    top.containsLayers.insert(0);
+    top.elementBoundingBox = {std::array<NumericType, 2>{0.05, 0.02},
+                              std::array<NumericType, 2>{0.25, 0.08}};
+    for (NumericType x : {0., 0.2}) {
+      GDS::SRef<NumericType> sref;
+      sref.strName = "square";
+      sref.refPoint = {x, 0., 0.};
+      top.sRefs.push_back(sref);
+    }
+    // rotated instance
+    GDS::SRef<NumericType> rotated;
+    rotated.strName = "square";
+    rotated.refPoint = {0.5, 0., 0.};
+    rotated.angle = 45.;
+    top.sRefs.push_back(rotated);
+    // 3x2 array above
+    GDS::ARef<NumericType> array;
+    array.strName = "square";
+    array.refPoints = {std::array<NumericType, 3>{0., 0.2, 0.},
+                       std::array<NumericType, 3>{0.6, 0.2, 0.},
+                       std::array<NumericType, 3>{0., 0.6, 0.}};
+    array.arrayDims = {2, 3};
+    top.aRefs.push_back(array);
+
+    auto geometry = SmartPointer<GDSGeometry<NumericType, D>>::New(gridDelta);
+    geometry->setBoundaryConditions(boundaryConditions);
+    geometry->setBoundaryPadding(0.05, 0.05);
+    geometry->insertNextStructure(square);
+    geometry->insertNextStructure(top);
+    geometry->finalize();
+
+    auto boundingBox = geometry->getBoundingBox();
+    VC_TEST_ASSERT(std::abs(boundingBox[1][0] - 0.5 - 0.1 * std::sqrt(0.5)) <
+                   1e-5);
+    VC_TEST_ASSERT(std::abs(boundingBox[1][1] - 0.5) < 1e-5);
+
+    auto layer = geometry->layerToLevelSet(0, 0., 0.05);
+    VC_TEST_ASSERT(layer->getNumberOfPoints() > 0);
+    LSTEST_ASSERT_VALID_LS(layer, NumericType, D);
+
+    auto maskLayer = geometry->layerToLevelSet(0, 0., 0.05, true);
+    LSTEST_ASSERT_VALID_LS(maskLayer, NumericType, D);
+
+    auto emptyLayer = geometry->layerToLevelSet(1, 0., 0.05);
+    VC_TEST_ASSERT(emptyLayer->getNumberOfPoints() == 0);
+
+    // only convert the array
+    geometry->setSimulationWindow(0., 0.2, 0.6, 0.6);
+    VC_TEST_ASSERT(geometry->getBounds()[2] == NumericType(0.2));
+    auto windowLayer = geometry->layerToLevelSet(0, 0., 0.05);
+    VC_TEST_ASSERT(windowLayer->getNumberOfPoints() > 0);
+    VC_TEST_ASSERT(windowLayer->getNumberOfPoints() <
+                   layer->getNumberOfPoints());
+    LSTEST_ASSERT_VALID_LS(windowLayer, NumericType, D);
+    geometry->clearSimulationWindow();
+
+    // concurrent conversion of several layers
+    auto levelSets = geometry->layersToLevelSets(
+        {{0, 0., 0.05, false}, {1, 0., 0.05, false}, {0, 0., 0.05, true}});
+    VC_TEST_ASSERT(levelSets.size() == 3);
+    VC_TEST_ASSERT(levelSets[0]->getNumberOfPoints() ==
+                   layer->getNumberOfPoints());
+    VC_TEST_ASSERT(levelSets[1]->getNumberOfPoints() == 0);
+    LSTEST_ASSERT_VALID_LS(levelSets[2], NumericType, D);
+  }
+
+  {
+    // abutting and overlapping rectangles match a single rectangle
+    auto convert = [&](const GDS::Structure<NumericType> &str) {
+      auto geometry =
+          SmartPointer<GDSGeometry<NumericType, D>>::New(gridDelta);
+      geometry->setBoundaryConditions(boundaryConditions);
+      geometry->setBoundaryPadding(0.05, 0.05);
+      geometry->insertNextStructure(str);
+      geometry->finalize();
+      return geometry->layerToLevelSet(0, 0., 0.05);
+    };
+
+    auto merged = convert(rectangles<NumericType>("merged", {{0., 0.2}}));
+    const auto mergedArea = surfaceArea(merged);
+    LSTEST_ASSERT_VALID_LS(merged, NumericType, D);
+
+    // shared edge on and between grid points, overlapping rectangles
+    for (const NumericType split : {0.1, 0.105}) {
+      for (const NumericType overlap : {0., 0.023}) {
+        auto layer = convert(rectangles<NumericType>(
+            "split", {{0., split + overlap}, {split, 0.2}}));
+        LSTEST_ASSERT_VALID_LS(layer, NumericType, D);
+        VC_TEST_ASSERT(layer->getNumberOfPoints() ==
+                       merged->getNumberOfPoints());
+        VC_TEST_ASSERT(std::abs(surfaceArea(layer) - mergedArea) <
+                       1e-3 * mergedArea);
+      }
+    }
+  }
 }
 
 } // namespace viennacore
@@ -5,8 +5,12 @@
 #include <psProcess.hpp>
 
 #include <lsTestAsserts.hpp>
+#include <lsToSurfaceMesh.hpp>
 #include <vcTestAsserts.hpp>
 
+#include <cmath>
+#include <limits>
+
 namespace viennacore {
 
 using namespace viennaps;
@@ -56,6 +60,74 @@ template <class NumericType, int D> void RunTest() {
     VC_TEST_ASSERT(domain->getMaterialMap()->size() == 2);
     LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
   }
+
+  // Etching through the mask opening leaves a cavity whose surface is at the
+  // etch distance from the opening, including the undercut below the mask
+  {
+    const NumericType gridDelta = 1.;
+    const NumericType trenchWidth = 4.;
+    const NumericType maskHeight = 3.;
+    const NumericType baseHeight = 1.;
+    const NumericType rate = -1.;
+    const NumericType time = 2.;
+    const NumericType distance = -rate * time;
+
+    for (const bool analytic : {true, false}) {
+      auto domain = SmartPointer<Domain<NumericType, D>>::New();
+      MakeTrench<NumericType, D>(domain, gridDelta, 12., 10., trenchWidth,
+                                 maskHeight, 0., baseHeight, false, true,
+                                 Material::Si)
+          .apply();
+      auto model = SmartPointer<IsotropicProcess<NumericType, D>>::New(
+          rate, Material::Mask);
+      if (analytic)
+        model->enableAnalyticOffset();
+      Process<NumericType, D>(domain, model, time).apply();
+
+      VC_TEST_ASSERT(domain->getLevelSets().size() == 2);
+      LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
+
+      auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
+      viennals::ToSurfaceMesh<NumericType, D>(domain->getLevelSets().back(),
+                                              mesh)
+          .apply();
+      const NumericType tolerance = (analytic ? 0.5 : 1.) * gridDelta;
+      NumericType lowest = std::numeric_limits<NumericType>::max();
+      NumericType undercut = 0.;
+      for (const auto &node : mesh->nodes) {
+        const NumericType depth = baseHeight - node[D - 1];
+        if (depth < 0.5 * gridDelta)
+          continue;
+        const NumericType lateral =
+            std::max(std::abs(node[0]) - trenchWidth / 2, NumericType(0));
+        VC_TEST_ASSERT(std::abs(std::sqrt(lateral * lateral + depth * depth) -
+                                distance) < tolerance);
+        lowest = std::min(lowest, node[D - 1]);
+        undercut = std::max(undercut, lateral);
+      }
+      VC_TEST_ASSERT(std::abs(lowest - (baseHeight - distance)) < tolerance);
+      VC_TEST_ASSERT(undercut > distance - gridDelta);
+
+      // the mask is not etched
+      viennals::ToSurfaceMesh<NumericType, D>(domain->getLevelSets().front(),
+                                              mesh)
+          .apply();
+      for (const auto &node : mesh->nodes) {
+        VC_TEST_ASSERT(node[D - 1] > baseHeight - 0.25 * gridDelta);
+        VC_TEST_ASSERT(node[D - 1] < baseHeight + maskHeight +
+                                         0.25 * gridDelta);
+      }
+    }
+  }
+
+  {
+    auto model = SmartPointer<IsotropicProcess<NumericType, D>>::New(
+        -1., Material::Mask);
+    model->enableAnalyticOffset();
+    VC_TEST_ASSERT(model->getGeometricModel());
+    model->disableAnalyticOffset();
+    VC_TEST_ASSERT(!model->getGeometricModel());
+  }
 }
 
 } // namespace viennacore
@@ -0,0 +1,270 @@
+#include <geometries/psMakeStack.hpp>
+#include <models/psOxideRegrowth.hpp>
+
+#include <psDomain.hpp>
+#include <psToDiskMesh.hpp>
+#include <vcTestAsserts.hpp>
+
+#include <lsAdvect.hpp>
+#include <lsTestAsserts.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+template <class NumericType, int D> struct Stack {
+  static constexpr NumericType gridDelta = 2.;
+  static constexpr int numLayers = 3;
+  static constexpr NumericType layerHeight = 10.;
+  static constexpr NumericType substrateHeight = 10.;
+  static constexpr NumericType trenchWidth = 20.;
+  static constexpr NumericType top = substrateHeight + numLayers * layerHeight;
+
+  static auto makeDomain(NumericType holeRadius = 0.) {
+    auto domain = SmartPointer<Domain<NumericType, D>>::New();
+    MakeStack<NumericType, D>(domain, gridDelta, 60., 20., numLayers,
+                              layerHeight, substrateHeight, holeRadius,
+                              trenchWidth, 0., false)
+        .apply();
+    domain->duplicateTopLevelSet(Material::Polymer);
+    domain->generateCellSet(top + 10., Material::GAS, true);
+    auto &cellSet = domain->getCellSet();
+    cellSet->addScalarData("byproductSum", 0.);
+    cellSet->buildNeighborhood();
+    return domain;
+  }
+
+  static constexpr NumericType redepoFactor = 0.01;
+  static constexpr NumericType redepoThreshold = 0.2;
+
+  static auto makeDynamics(NumericType diffusionCoefficient, NumericType sink,
+                           NumericType velocity, NumericType redepoTimeInt,
+                           bool implicit) {
+    auto dynamics =
+        SmartPointer<impl::ByproductDynamics<NumericType, D>>::New(
+            diffusionCoefficient, sink, velocity, velocity, top, trenchWidth,
+            1., redepoFactor, redepoThreshold, redepoTimeInt,
+            D == 2 ? 0.245 : 0.145);
+    dynamics->setImplicitDiffusion(implicit);
+    return dynamics;
+  }
+
+  // Byproduct concentration increasing smoothly with the height
+  static void seedGasCells(SmartPointer<Domain<NumericType, D>> domain) {
+    auto &cellSet = domain->getCellSet();
+    auto data = cellSet->getFillingFractions();
+    auto materialIds = cellSet->getScalarData("Material");
+    auto elems = cellSet->getElements();
+    auto nodes = cellSet->getNodes();
+    for (std::size_t e = 0; e < data->size(); ++e) {
+      if (!MaterialMap::isMaterial(materialIds->at(e), Material::GAS))
+        continue;
+      const NumericType height = nodes[elems[e][0]][D - 1] + gridDelta / 2.;
+      data->at(e) = 1. + height / top;
+    }
+  }
+
+  static NumericType gasMass(SmartPointer<Domain<NumericType, D>> domain) {
+    auto &cellSet = domain->getCellSet();
+    auto data = cellSet->getFillingFractions();
+    auto materialIds = cellSet->getScalarData("Material");
+    NumericType mass = 0.;
+    for (std::size_t e = 0; e < data->size(); ++e)
+      if (MaterialMap::isMaterial(materialIds->at(e), Material::GAS))
+        mass += data->at(e);
+    return mass;
+  }
+
+  // Relative L1 difference of the concentrations of two domains
+  static NumericType difference(SmartPointer<Domain<NumericType, D>> a,
+                                SmartPointer<Domain<NumericType, D>> b) {
+    auto dataA = a->getCellSet()->getFillingFractions();
+    auto dataB = b->getCellSet()->getFillingFractions();
+    NumericType diff = 0., norm = 0.;
+    for (std::size_t e = 0; e < dataA->size(); ++e) {
+      diff += std::abs(dataA->at(e) - dataB->at(e));
+      norm += std::abs(dataA->at(e));
+    }
+    return diff / norm;
+  }
+};
+
+// Nearest disk velocities by a linear search over all disks
+template <class NumericType>
+class NearestDiskVelocityField : public viennals::VelocityField<NumericType> {
+public:
+  NearestDiskVelocityField(std::vector<NumericType> passedVelocities,
+                           std::vector<Vec3D<NumericType>> passedPoints)
+      : velocities(std::move(passedVelocities)),
+        points(std::move(passedPoints)) {}
+
+  NumericType getScalarVelocity(const Vec3D<NumericType> &coordinate, int,
+                                const Vec3D<NumericType> &,
+                                unsigned long) override {
+    std::size_t nearest = 0;
+    NumericType minDistance = std::numeric_limits<NumericType>::max();
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      const auto distance = Norm2(points[i] - coordinate);
+      if (distance < minDistance) {
+        minDistance = distance;
+        nearest = i;
+      }
+    }
+    return velocities[nearest];
+  }
+
+private:
+  std::vector<NumericType> velocities;
+  std::vector<Vec3D<NumericType>> points;
+};
+
+// Redeposition of the original implementation: the gas cells around each
+// oxide disk are looked up directly and the level set points take the
+// velocity of their nearest disk.
+template <class NumericType, int D>
+void referenceRedeposition(SmartPointer<Domain<NumericType, D>> domain,
+                           NumericType processTime) {
+  using StackType = Stack<NumericType, D>;
+  auto &cellSet = domain->getCellSet();
+  auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
+  ToDiskMesh<NumericType, D>(domain, mesh).apply();
+
+  const auto &points = mesh->nodes;
+  auto materialIds = mesh->getCellData().getScalarData("MaterialIds");
+  auto ff = cellSet->getScalarData("byproductSum");
+  auto cellMatIds = cellSet->getScalarData("Material");
+  auto isGas = [&](int cellIdx) {
+    return MaterialMap::mapToMaterial(cellMatIds->at(cellIdx)) ==
+           Material::GAS;
+  };
+
+  std::vector<NumericType> depoRate(points.size(), 0.);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto material = MaterialMap::mapToMaterial(materialIds->at(i));
+    if ((material != Material::SiO2 && material != Material::Polymer) ||
+        points[i][D - 1] >= StackType::top)
+      continue;
+    const auto cellIdx = cellSet->getIndex(points[i]);
+    if (cellIdx == -1)
+      continue;
+    int n = 0;
+    if (isGas(cellIdx)) {
+      depoRate[i] = ff->at(cellIdx);
+      n++;
+    }
+    for (const auto ni : cellSet->getNeighbors(cellIdx)) {
+      if (ni != -1 && isGas(ni)) {
+        depoRate[i] += ff->at(ni);
+        n++;
+      }
+    }
+    if (n > 1)
+      depoRate[i] /= static_cast<NumericType>(n);
+    depoRate[i] /= processTime;
+    if (depoRate[i] < StackType::redepoThreshold)
+      depoRate[i] = 0.;
+    depoRate[i] *= StackType::redepoFactor;
+  }
+
+  viennals::Advect<NumericType, D> advectionKernel;
+  advectionKernel.insertNextLevelSet(domain->getLevelSets().back());
+  advectionKernel.setVelocityField(
+      SmartPointer<NearestDiskVelocityField<NumericType>>::New(depoRate,
+                                                               points));
+  advectionKernel.setAdvectionTime(processTime);
+  advectionKernel.apply();
+}
+
+// Surface disks of the top level set
+template <class NumericType, int D>
+auto surfacePoints(SmartPointer<Domain<NumericType, D>> domain) {
+  auto mesh = SmartPointer<viennals::Mesh<NumericType>>::New();
+  ToDiskMesh<NumericType, D>(domain, mesh).apply();
+  return mesh->nodes;
+}
+
+template <class NumericType>
+NumericType maxDistance(const std::vector<Vec3D<NumericType>> &a,
+                        const std::vector<Vec3D<NumericType>> &b) {
+  NumericType distance = 0.;
+  for (std::size_t i = 0; i < a.size(); ++i)
+    distance = std::max(distance, Norm(a[i] - b[i]));
+  return distance;
+}
+
+template <class NumericType, int D> void RunTest() {
+  Logger::setLogLevel(LogLevel::WARNING);
+  using StackType = Stack<NumericType, D>;
+
+  // The implicit diffusion solver matches the explicit one
+  for (const NumericType velocity : {NumericType(0.), NumericType(7.5)}) {
+    auto explicitDomain = StackType::makeDomain();
+    auto implicitDomain = StackType::makeDomain();
+    auto explicitDynamics =
+        StackType::makeDynamics(50., 0., velocity, 60., false);
+    auto implicitDynamics =
+        StackType::makeDynamics(50., 0., velocity, 60., true);
+    explicitDynamics->setDomain(explicitDomain);
+    implicitDynamics->setDomain(implicitDomain);
+
+    // extract the surface without redeposition
+    explicitDynamics->applyPreAdvect(0.);
+    implicitDynamics->applyPreAdvect(0.);
+    StackType::seedGasCells(explicitDomain);
+    StackType::seedGasCells(implicitDomain);
+
+    explicitDynamics->applyPostAdvect(2.);
+    implicitDynamics->applyPostAdvect(2.);
+
+    const auto explicitMass = StackType::gasMass(explicitDomain);
+    const auto implicitMass = StackType::gasMass(implicitDomain);
+    VC_TEST_ASSERT(explicitMass > 0.);
+    if (velocity == 0.) {
+      // pure diffusion conserves the byproducts
+      VC_TEST_ASSERT(std::abs(implicitMass - explicitMass) <
+                     1e-3 * explicitMass);
+    }
+    VC_TEST_ASSERT(StackType::difference(explicitDomain, implicitDomain) <
+                   5e-2);
+  }
+
+  // Redeposition in a small hole matches the original implementation
+  {
+    const NumericType processTime = 10.;
+    auto domain = StackType::makeDomain(6.);
+    auto reference = StackType::makeDomain(6.);
+    auto initialPoints = surfacePoints(domain);
+
+    // enough byproducts to redeposit on every oxide disk
+    for (auto d : {domain, reference}) {
+      auto sum = d->getCellSet()->getScalarData("byproductSum");
+      std::fill(sum->begin(), sum->end(), 100. * processTime);
+    }
+
+    auto dynamics = StackType::makeDynamics(50., 0., 0., processTime, false);
+    dynamics->setDomain(domain);
+    dynamics->applyPreAdvect(0.);
+    dynamics->applyPreAdvect(processTime);
+    referenceRedeposition(reference, processTime);
+
+    auto points = surfacePoints(domain);
+    auto referencePoints = surfacePoints(reference);
+    LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
+    VC_TEST_ASSERT(points.size() == referencePoints.size());
+    VC_TEST_ASSERT(maxDistance(points, referencePoints) <
+                   1e-4 * StackType::gridDelta);
+
+    // the oxide has grown into the hole
+    VC_TEST_ASSERT(points.size() != initialPoints.size() ||
+                   maxDistance(points, initialPoints) >
+                       StackType::gridDelta / 2.);
+  }
+}
+
+} // namespace viennacore
+
+int main() { VC_RUN_ALL_TESTS }
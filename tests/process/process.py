@@ -0,0 +1,80 @@
+import gc
+
+import numpy as np
+
+
+def run(vps):
+    domain = vps.Domain()
+    vps.MakeTrench(
+        domain=domain,
+        gridDelta=1.0,
+        xExtent=10.0,
+        yExtent=10.0,
+        trenchWidth=5.0,
+        trenchDepth=5.0,
+        taperingAngle=0.0,
+        baseHeight=0.0,
+        periodicBoundary=False,
+        makeMask=True,
+        material=vps.Material.Si,
+    ).apply()
+
+    model = vps.SingleParticleProcess(
+        rate=1.0,
+        stickingProbability=0.5,
+        sourceExponent=1.0,
+        maskMaterial=vps.Material.Mask,
+    )
+    mesh = vps.Process(domain, model, 0.0).calculateFlux()
+
+    # shape and type of the views
+    nodes = vps.meshNodes(mesh)
+    flux = vps.meshScalarData(mesh, "particleFlux")
+    normals = vps.meshVectorData(mesh, "Normals")
+    numPoints = len(nodes)
+    assert numPoints > 0
+    assert nodes.shape == (numPoints, 3)
+    assert flux.shape == (numPoints,)
+    assert normals.shape == (numPoints, 3)
+    for view in (nodes, flux, normals):
+        assert view.dtype == np.float64
+    assert np.all(flux >= 0.0) and flux.max() > 0.0
+    assert np.allclose(np.linalg.norm(normals, axis=1), 1.0)
+
+    with np.testing.assert_raises(KeyError):
+        vps.meshScalarData(mesh, "noFlux")
+
+    # writing through a view changes the data of the mesh
+    flux[0] = -1.0
+    nodes[0, 0] = 1234.0
+    assert vps.meshScalarData(mesh, "particleFlux")[0] == -1.0
+    assert vps.meshNodes(mesh)[0, 0] == 1234.0
+
+    # the views keep the mesh alive
+    expected = flux.copy()
+    del mesh
+    gc.collect()
+    assert np.array_equal(flux, expected)
+    assert nodes[0, 0] == 1234.0
+
+    # disk meshes of the domain
+    diskMesh = vps.ls.Mesh()
+    vps.ToDiskMesh(domain, diskMesh).apply()
+    diskNodes = vps.meshNodes(diskMesh)
+    assert diskNodes.shape == (numPoints, 3)
+    del diskMesh
+    gc.collect()
+    assert np.isfinite(diskNodes).all()
+
+
+if __name__ == "__main__":
+    import viennaps2d
+
+    run(viennaps2d)
+    print("2D test passed")
+
+    import viennaps3d
+
+    run(viennaps3d)
+    print("3D test passed")
+    print("All tests passed")
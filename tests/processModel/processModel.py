@@ -0,0 +1,67 @@
+import gc
+
+import numpy as np
+
+
+def run(vps):
+    class EtchModel(vps.SurfaceModel):
+        def __init__(self):
+            super().__init__()
+            self.minHeights = []
+
+        def calculateVelocities(self, rates, coordinates, materialIds):
+            self.minHeights.append(coordinates[:, vps.D - 1].min())
+            return -np.ones(len(materialIds))
+
+    class ScaledVelocityField(vps.VelocityField):
+        def __init__(self):
+            super().__init__()
+            self.numCalls = 0
+
+        def setVelocities(self, velocities):
+            self.numCalls += 1
+            velocities *= 2.0
+
+    domain = vps.Domain()
+    vps.MakePlane(
+        domain=domain,
+        gridDelta=1.0,
+        xExtent=10.0,
+        yExtent=10.0,
+        height=0.0,
+        periodicBoundary=False,
+        material=vps.Material.Si,
+    ).apply()
+
+    # the models are only referenced by the process model
+    model = vps.ProcessModel()
+    model.setSurfaceModel(EtchModel())
+    model.setVelocityField(ScaledVelocityField())
+    gc.collect()
+
+    vps.Process(domain, model, 2.0).apply()
+
+    surfaceModel = model.getSurfaceModel()
+    velocityField = model.getVelocityField()
+    assert isinstance(surfaceModel, EtchModel)
+    assert isinstance(velocityField, ScaledVelocityField)
+    assert len(surfaceModel.minHeights) > 1
+    assert velocityField.numCalls > 1
+
+    # the surface is etched by twice the rate returned by the surface model
+    numCalls = len(surfaceModel.minHeights)
+    vps.Process(domain, model, 0.1).apply()
+    assert abs(surfaceModel.minHeights[numCalls] + 4.0) < 0.5
+
+
+if __name__ == "__main__":
+    import viennaps2d
+
+    run(viennaps2d)
+    print("2D test passed")
+
+    import viennaps3d
+
+    run(viennaps3d)
+    print("3D test passed")
+    print("All tests passed")
@@ -0,0 +1,166 @@
+#include <compact/psDataView.hpp>
+#include <compact/psRectilinearGridInterpolation.hpp>
+
+#include <vcTestAsserts.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+constexpr std::size_t inputDim = 3;
+constexpr std::size_t outputDim = 2;
+
+// Multilinear interpolation computed directly from the data rows. Inputs
+// outside of the grid are clamped to its bounds.
+template <class NumericType>
+std::vector<NumericType>
+reference(const std::vector<std::vector<NumericType>> &rows,
+          const std::array<std::vector<NumericType>, inputDim> &axes,
+          const std::vector<NumericType> &input) {
+  std::vector<NumericType> result(outputDim, 0.);
+  for (const auto &row : rows) {
+    NumericType weight = 1.;
+    for (std::size_t i = 0; i < inputDim && weight != 0.; ++i) {
+      const auto &axis = axes[i];
+      const NumericType x = std::clamp(input[i], axis.front(), axis.back());
+      auto upper = std::upper_bound(axis.begin(), axis.end(), x);
+      if (upper == axis.end()) {
+        weight *= row[i] == axis.back() ? 1. : 0.;
+        continue;
+      }
+      const NumericType lower = *(upper - 1);
+      const NumericType t = (x - lower) / (*upper - lower);
+      if (row[i] == lower)
+        weight *= 1 - t;
+      else if (row[i] == *upper)
+        weight *= t;
+      else
+        weight = 0.;
+    }
+    for (std::size_t k = 0; k < outputDim; ++k)
+      result[k] += weight * row[inputDim + k];
+  }
+  return result;
+}
+
+template <class NumericType>
+void compare(RectilinearGridInterpolation<NumericType> &estimator,
+             const std::vector<std::vector<NumericType>> &rows,
+             const std::array<std::vector<NumericType>, inputDim> &axes,
+             const std::vector<std::vector<NumericType>> &inputs) {
+  const NumericType tolerance =
+      100 * std::numeric_limits<NumericType>::epsilon();
+  for (const auto &input : inputs) {
+    auto estimateOpt = estimator.estimate(input);
+    VC_TEST_ASSERT(estimateOpt.has_value());
+    const auto &[value, isInside] = *estimateOpt;
+
+    bool expectInside = true;
+    for (std::size_t i = 0; i < inputDim; ++i)
+      if (input[i] < axes[i].front() || input[i] > axes[i].back())
+        expectInside = false;
+    VC_TEST_ASSERT(isInside == expectInside);
+
+    const auto expected = reference(rows, axes, input);
+    VC_TEST_ASSERT(value.size() == outputDim);
+    for (std::size_t k = 0; k < outputDim; ++k)
+      VC_TEST_ASSERT(std::abs(value[k] - expected[k]) <=
+                     tolerance * (1 + std::abs(expected[k])));
+  }
+}
+
+template <class NumericType, int D> void RunTest() {
+  // non-uniform grid with a shuffled row order
+  const std::array<std::vector<NumericType>, inputDim> axes = {
+      std::vector<NumericType>{0., 0.5, 2.},
+      std::vector<NumericType>{-1., 0., 1., 3.},
+      std::vector<NumericType>{0., 1.}};
+  std::vector<std::vector<NumericType>> rows;
+  for (auto x : axes[0])
+    for (auto y : axes[1])
+      for (auto z : axes[2])
+        rows.push_back({x, y, z, x * y + z * z * x - y * y * z,
+                        std::sin(x) + std::cos(y * z)});
+  std::mt19937 rng(7);
+  std::shuffle(rows.begin(), rows.end(), rng);
+
+  std::vector<std::vector<NumericType>> inputs;
+  // inside the grid
+  std::uniform_real_distribution<NumericType> unit(0., 1.);
+  for (int n = 0; n < 200; ++n) {
+    std::vector<NumericType> input(inputDim);
+    for (std::size_t i = 0; i < inputDim; ++i)
+      input[i] =
+          axes[i].front() + unit(rng) * (axes[i].back() - axes[i].front());
+    inputs.push_back(input);
+  }
+  // on the grid points, including the boundary
+  for (const auto &row : rows)
+    inputs.emplace_back(row.begin(), row.begin() + inputDim);
+  // out of range along one or all axes
+  for (std::size_t i = 0; i < inputDim; ++i) {
+    std::vector<NumericType> input = {1., 0.5, 0.5};
+    input[i] = axes[i].front() - 0.7;
+    inputs.push_back(input);
+    input[i] = axes[i].back() + 0.7;
+    inputs.push_back(input);
+  }
+  inputs.push_back({-5., -5., -5.});
+  inputs.push_back({5., 5., 5.});
+  inputs.push_back({-5., 0.3, 5.});
+
+  // row input
+  {
+    RectilinearGridInterpolation<NumericType> estimator;
+    estimator.setDataDimensions(inputDim, outputDim);
+    estimator.setData(
+        SmartPointer<const std::vector<std::vector<NumericType>>>::New(rows));
+    compare(estimator, rows, axes, inputs);
+  }
+
+  // row-major and column-major view input
+  std::vector<NumericType> rowMajor, columnMajor;
+  for (const auto &row : rows)
+    rowMajor.insert(rowMajor.end(), row.begin(), row.end());
+  for (std::size_t j = 0; j < inputDim + outputDim; ++j)
+    for (const auto &row : rows)
+      columnMajor.push_back(row[j]);
+  for (const auto &view :
+       {DataView<NumericType>::rowMajor(rowMajor.data(), rows.size(),
+                                        inputDim + outputDim),
+        DataView<NumericType>::columnMajor(columnMajor.data(), rows.size(),
+                                           inputDim + outputDim)}) {
+    RectilinearGridInterpolation<NumericType> estimator;
+    estimator.setDataDimensions(inputDim, outputDim);
+    estimator.setData(view);
+    compare(estimator, rows, axes, inputs);
+  }
+
+  // data that does not form a rectilinear grid is rejected
+  {
+    auto incomplete = rows;
+    incomplete.pop_back();
+    RectilinearGridInterpolation<NumericType> estimator;
+    estimator.setDataDimensions(inputDim, outputDim);
+    estimator.setData(
+        SmartPointer<const std::vector<std::vector<NumericType>>>::New(
+            incomplete));
+    VC_TEST_ASSERT(!estimator.estimate({1., 0.5, 0.5}).has_value());
+  }
+}
+
+} // namespace viennacore
+
+// The interpolation does not depend on the dimension
+int main() {
+  viennacore::Logger::setLogLevel(viennacore::LogLevel::ERROR);
+  viennacore::RunTest<double, 2>();
+  viennacore::RunTest<float, 2>();
+}
@@ -0,0 +1,101 @@
+#include <geometries/psMakeTrench.hpp>
+#include <models/psSingleParticleProcess.hpp>
+
+#include <lsTestAsserts.hpp>
+#include <psDomain.hpp>
+#include <psProcess.hpp>
+#include <psSurrogateFlux.hpp>
+#include <vcTestAsserts.hpp>
+
+#include <cmath>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+template <class NumericType, int D> void RunTest() {
+  Logger::setLogLevel(LogLevel::WARNING);
+
+  const NumericType trenchWidth = 5.;
+  auto surrogate =
+      SmartPointer<SurrogateFlux<NumericType, D>>::New(trenchWidth);
+  surrogate->addFlux("particleFlux", 0.5, 1.);
+
+  auto makeDomain = [&]() {
+    auto domain = SmartPointer<Domain<NumericType, D>>::New();
+    MakeTrench<NumericType, D>(domain, 1., 10., 10., trenchWidth, 5., 10., 1.,
+                               false, true, Material::Si)
+        .apply();
+    return domain;
+  };
+  auto model = SmartPointer<SingleParticleProcess<NumericType, D>>::New(
+      1., 0.5, 1., Material::Mask);
+
+  // flux of the initial geometry, ray traced or predicted by the surrogate
+  auto initialFlux = [&](bool predict) {
+    auto domain = makeDomain();
+    Process<NumericType, D> process(domain, model, 0.);
+    if (predict)
+      process.setSurrogateFlux(surrogate);
+    auto mesh = process.calculateFlux();
+    auto flux = mesh->getCellData().getScalarData("particleFlux");
+    VC_TEST_ASSERT(flux);
+    VC_TEST_ASSERT(flux->size() == mesh->getNodes().size());
+    return *flux;
+  };
+
+  // record the ray traced fluxes
+  {
+    auto domain = makeDomain();
+    Process<NumericType, D> process(domain, model, 2.);
+    process.setSurrogateFlux(surrogate);
+    process.apply();
+
+    VC_TEST_ASSERT(surrogate->getNumberOfSamples() > 0);
+    for (const auto &sample : surrogate->getSamples())
+      VC_TEST_ASSERT(sample.size() == 5);
+  }
+
+  // run the same process with fluxes from the surrogate
+  {
+    auto domain = makeDomain();
+    surrogate->setMode(SurrogateFluxMode::PREDICT);
+    VC_TEST_ASSERT(surrogate->initialize());
+
+    const auto numSamples = surrogate->getNumberOfSamples();
+    Process<NumericType, D> process(domain, model, 2.);
+    process.setSurrogateFlux(surrogate);
+    process.apply();
+
+    VC_TEST_ASSERT(surrogate->getNumberOfSamples() == numSamples);
+    VC_TEST_ASSERT(process.getProcessDuration() > 0.);
+    VC_TEST_ASSERT(domain->getLevelSets().size() == 2);
+    LSTEST_ASSERT_VALID_LS(domain->getLevelSets().back(), NumericType, D);
+
+    // no rays are traced
+    const auto &steps = process.getStatistics().steps;
+    VC_TEST_ASSERT(!steps.empty());
+    for (const auto &step : steps)
+      VC_TEST_ASSERT(step.raysTraced.empty());
+  }
+
+  // the predicted flux on the recorded geometry matches the traced one
+  {
+    const auto predicted = initialFlux(true);
+    const auto traced = initialFlux(false);
+    VC_TEST_ASSERT(predicted.size() == traced.size());
+
+    NumericType error = 0., norm = 0.;
+    for (std::size_t i = 0; i < traced.size(); ++i) {
+      VC_TEST_ASSERT(predicted[i] >= 0.);
+      error += std::abs(predicted[i] - traced[i]);
+      norm += traced[i];
+    }
+    VC_TEST_ASSERT(norm > 0.);
+    VC_TEST_ASSERT(error < 0.2 * norm);
+  }
+}
+
+} // namespace viennacore
+
+int main() { VC_RUN_ALL_TESTS }
@@ -0,0 +1,125 @@
+#include <compact/psNearestNeighborsInterpolation.hpp>
+#include <compact/psRectilinearGridInterpolation.hpp>
+#include <compact/psValueEstimator.hpp>
+
+#include <vcTestAsserts.hpp>
+
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace viennacore {
+
+using namespace viennaps;
+
+// Doubles the input and fails for negative inputs
+template <class NumericType>
+class DoublingEstimator : public ValueEstimator<NumericType, int> {
+  using Parent = ValueEstimator<NumericType, int>;
+  using typename Parent::ItemType;
+
+public:
+  DoublingEstimator() { this->setDataDimensions(1, 1); }
+
+  std::optional<std::tuple<ItemType, int>>
+  estimate(const ItemType &input) override {
+    if (input[0] < 0.)
+      return {};
+    return {{ItemType{2 * input[0]}, static_cast<int>(input[0])}};
+  }
+};
+
+// Compares estimateBatch with and without feedback to a loop over estimate
+template <class NumericType, class Estimator, class FeedbackType>
+void compareBatch(Estimator &estimator, const std::vector<NumericType> &inputs,
+                  std::size_t numInputs) {
+  const auto inputDim = estimator.getInputDimension();
+  const auto outputDim = estimator.getOutputDimension();
+
+  std::vector<NumericType> outputs(numInputs * outputDim);
+  std::vector<std::tuple<FeedbackType>> feedback(numInputs);
+  VC_TEST_ASSERT(estimator.estimateBatch(inputs.data(), numInputs,
+                                         outputs.data(), feedback.data()));
+
+  std::vector<NumericType> outputsNoFeedback(numInputs * outputDim);
+  VC_TEST_ASSERT(estimator.estimateBatch(inputs.data(), numInputs,
+                                         outputsNoFeedback.data()));
+  VC_TEST_ASSERT(outputsNoFeedback == outputs);
+
+  for (std::size_t n = 0; n < numInputs; ++n) {
+    std::vector<NumericType> input(inputs.begin() + n * inputDim,
+                                   inputs.begin() + (n + 1) * inputDim);
+    auto estimateOpt = estimator.estimate(input);
+    VC_TEST_ASSERT(estimateOpt.has_value());
+    const auto &[value, flag] = *estimateOpt;
+    VC_TEST_ASSERT(value.size() == outputDim);
+    for (std::size_t k = 0; k < outputDim; ++k)
+      VC_TEST_ASSERT(value[k] == outputs[n * outputDim + k]);
+    VC_TEST_ASSERT(flag == std::get<0>(feedback[n]));
+  }
+}
+
+template <class NumericType, int D> void RunTest() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<NumericType> dist(-0.2, 1.2);
+
+  // grid data with two outputs
+  std::vector<std::vector<NumericType>> rows;
+  for (int i = 0; i < 6; ++i)
+    for (int j = 0; j < 5; ++j) {
+      const NumericType x = i / 5., y = j * j / 16.;
+      rows.push_back({x, y, std::sin(3 * x) + y, x * y});
+    }
+  auto data =
+      SmartPointer<const std::vector<std::vector<NumericType>>>::New(rows);
+
+  const std::size_t numInputs = 500;
+  std::vector<NumericType> inputs(numInputs * 2);
+  for (auto &input : inputs)
+    input = dist(rng);
+
+  // overridden batch estimate with the inside flag as feedback
+  {
+    RectilinearGridInterpolation<NumericType> estimator;
+    estimator.setDataDimensions(2, 2);
+    estimator.setData(data);
+    compareBatch<NumericType, decltype(estimator), bool>(estimator, inputs,
+                                                         numInputs);
+  }
+
+  // generic batch estimate with the distance as feedback
+  {
+    NearestNeighborsInterpolation<NumericType> estimator;
+    estimator.setDataDimensions(2, 2);
+    estimator.setNumberOfNeighbors(3);
+    estimator.setData(data);
+    compareBatch<NumericType, decltype(estimator), NumericType>(
+        estimator, inputs, numInputs);
+  }
+
+  // failed estimates are set to NaN
+  {
+    DoublingEstimator<NumericType> estimator;
+    const std::vector<NumericType> values = {1., -1., 3.};
+    std::vector<NumericType> outputs(values.size());
+    std::vector<std::tuple<int>> feedback(values.size(), {-7});
+    VC_TEST_ASSERT(!estimator.estimateBatch(values.data(), values.size(),
+                                            outputs.data(), feedback.data()));
+    VC_TEST_ASSERT(outputs[0] == NumericType(2.));
+    VC_TEST_ASSERT(std::isnan(outputs[1]));
+    VC_TEST_ASSERT(outputs[2] == NumericType(6.));
+    VC_TEST_ASSERT(std::get<0>(feedback[0]) == 1);
+    VC_TEST_ASSERT(std::get<0>(feedback[1]) == -7);
+    VC_TEST_ASSERT(std::get<0>(feedback[2]) == 3);
+  }
+}
+
+} // namespace viennacore
+
+// The estimators do not depend on the dimension
+int main() {
+  viennacore::Logger::setLogLevel(viennacore::LogLevel::ERROR);
+  viennacore::RunTest<double, 2>();
+  viennacore::RunTest<float, 2>();
+}